@@ -0,0 +1,74 @@
+// binary-trees, same program as binary_trees.sn, with the same pool of nodes
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static unsigned long *pool;
+static unsigned long next = 1;
+
+static unsigned long bottom_up(long depth)
+{
+    unsigned long node = next++;
+
+    if (depth > 0)
+    {
+        pool[node * 2] = bottom_up(depth - 1);
+        pool[node * 2 + 1] = bottom_up(depth - 1);
+    }
+    else
+    {
+        pool[node * 2] = 0;
+        pool[node * 2 + 1] = 0;
+    }
+
+    return node;
+}
+
+static long item_check(unsigned long node)
+{
+    if (pool[node * 2] == 0)
+    {
+        return 1;
+    }
+
+    return 1 + item_check(pool[node * 2]) + item_check(pool[node * 2 + 1]);
+}
+
+int main(int argc, char **argv)
+{
+    long min_depth = 4;
+    long max_depth = argc > 1 ? atol(argv[1]) : 16;
+
+    if (max_depth < min_depth + 2)
+    {
+        max_depth = min_depth + 2;
+    }
+
+    pool = calloc((1UL << (max_depth + 2)) * 2 + 2, sizeof(unsigned long));
+
+    printf("%ld\n", item_check(bottom_up(max_depth + 1)));
+    next = 1;
+
+    unsigned long long_lived = bottom_up(max_depth);
+    unsigned long mark = next;
+
+    for (long depth = min_depth; depth <= max_depth; depth += 2)
+    {
+        long iterations = 1L << (max_depth - depth + min_depth);
+        long check = 0;
+
+        for (long i = 0; i < iterations; i++)
+        {
+            check += item_check(bottom_up(depth));
+            next = mark;
+        }
+
+        printf("%ld\n", check);
+    }
+
+    printf("%ld\n", item_check(long_lived));
+
+    free(pool);
+
+    return 0;
+}
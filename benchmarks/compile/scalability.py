@@ -0,0 +1,232 @@
+#!/usr/bin/env python3
+
+"""
+Compile time scalability of the compiler.
+
+Synthetic programs are generated along separate axes, each at growing sizes, and compiled with --time-trace.
+The time of each compiler phase, the wall time and the peak RSS are reported, with the exponent of their growth
+between two sizes: an exponent well above 1 is super-linear behaviour (name lookups in Scope and NameArray,
+generic instantiations in GenericType...). Results can be saved and compared against a previous run.
+"""
+
+import argparse
+import json
+import math
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+# Phases traced by the compiler, as "Total <phase>" events of the trace
+PHASES = ["Parse", "Elaborate", "Function", "InstantiateClass", "InstantiateFunction", "Optimize", "CodeGen", "Link"]
+
+
+def generate_functions(directory, size):
+    """`size` functions, each calling the previous one"""
+    lines = ["fn f0(x: i64) : i64 {", "    return x;", "}", ""]
+
+    for i in range(1, size):
+        lines += [f"fn f{i}(x: i64) : i64 {{", f"    return f{i - 1}(x) + {i};", "}", ""]
+
+    lines += ["fn main() {", f"    let x = f{size - 1}(0);", "}"]
+
+    return write(directory, "main.sn", lines)
+
+
+def generate_generics(directory, size):
+    """Vec and Map nested `size` times"""
+    nested = "i64"
+
+    for i in range(size):
+        nested = f"std::Vec<{nested}>" if i % 2 == 0 else f"std::Map<i64, {nested}>"
+
+    lines = ['import "vec"', 'import "map"', "", "fn main() {", f"    let value = {nested}::new();", "}"]
+
+    return write(directory, "main.sn", lines)
+
+
+def generate_overloads(directory, size):
+    """An overload set of `size` functions, each of them called once"""
+    lines = []
+
+    for i in range(size):
+        lines += [f"class C{i} {{", "    value: i64;", "}", ""]
+        lines += [f"fn overload(x: C{i}) : i64 {{", f"    return x.value + {i};", "}", ""]
+
+    lines += ["fn main() {", "    let total: i64 = 0;"]
+    lines += [f"    total += overload(C{i} {{ value = {i} }});" for i in range(size)]
+    lines += ["}"]
+
+    return write(directory, "main.sn", lines)
+
+
+def generate_long_function(directory, size):
+    """A single function of `size` statements"""
+    lines = ["fn main() {", "    let v0: i64 = 1;"]
+    lines += [f"    let v{i} = v{i - 1} * 3 + {i};" for i in range(1, size)]
+    lines += ["}"]
+
+    return write(directory, "main.sn", lines)
+
+
+def generate_imports(directory, size):
+    """A chain of `size` files, each importing the next one"""
+    for i in range(size):
+        if i + 1 < size:
+            lines = [f'import "./m{i + 1}"', "", f"fn g{i}(x: i64) : i64 {{", f"    return g{i + 1}(x) + 1;", "}"]
+        else:
+            lines = [f"fn g{i}(x: i64) : i64 {{", "    return x;", "}"]
+
+        write(directory, f"m{i}.sn", lines)
+
+    return write(directory, "main.sn", ['import "./m0"', "", "fn main() {", "    let x = g0(0);", "}"])
+
+
+def generate_literals(directory, size):
+    """A string literal of `size` adjacent pieces of 64 characters, the grammar has no array literal"""
+    pieces = [f'        "{chr(ord("a") + i % 26) * 64}"' for i in range(size)]
+    lines = ["fn main() {", "    let str =", *pieces, "    ;", "}"]
+
+    return write(directory, "main.sn", lines)
+
+
+# Axis: generator and sizes
+AXES = {
+    "functions": (generate_functions, [1000, 2000, 4000, 8000]),
+    "generics": (generate_generics, [2, 4, 8, 16]),
+    "overloads": (generate_overloads, [100, 200, 400, 800]),
+    "long_function": (generate_long_function, [1000, 2000, 4000, 8000]),
+    "imports": (generate_imports, [50, 100, 200, 400]),
+    "literals": (generate_literals, [1000, 2000, 4000, 8000]),
+}
+
+
+def write(directory, name, lines):
+    path = os.path.join(directory, name)
+
+    with open(path, "w") as file:
+        file.write("\n".join(lines) + "\n")
+
+    return path
+
+
+def build(sand, entry, output, optimization_level):
+    """Wall time in seconds, peak RSS in KB and the totals of the trace in milliseconds, or None on failure"""
+    command = [sand, "build", "-O", optimization_level, "--time-trace", "-o", output, entry]
+
+    # wait4 gives the peak RSS of this build alone
+    with tempfile.TemporaryFile() as errors:
+        start = time.monotonic()
+        process = subprocess.Popen(command, stdout=subprocess.DEVNULL, stderr=errors)
+        _, status, usage = os.wait4(process.pid, 0)
+        wall = time.monotonic() - start
+        process.returncode = status
+
+        if status != 0:
+            errors.seek(0)
+            print(f"{' '.join(command)} failed:\n{errors.read().decode(errors='replace')}", file=sys.stderr)
+            return None
+
+    with open(output + ".time-trace.json") as file:
+        events = json.load(file)["traceEvents"]
+
+    phases = {}
+
+    for event in events:
+        name = event.get("name", "")
+
+        if name.startswith("Total ") and name[6:] in PHASES:
+            phases[name[6:]] = event["dur"] / 1000
+
+    return {"wall": wall, "rss": usage.ru_maxrss, "phases": phases}
+
+
+def exponent(previous, current, previous_size, size):
+    if previous <= 0 or current <= 0:
+        return None
+
+    return math.log(current / previous) / math.log(size / previous_size)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--sand", default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "bin", "sand"), help="sand executable")
+    parser.add_argument("-O", dest="optimization_level", default="0", help="optimization level of the builds")
+    parser.add_argument("--axes", default=",".join(AXES), help="comma separated axes to run")
+    parser.add_argument("--exponent", type=float, default=1.3, help="growth exponent reported as super-linear")
+    parser.add_argument("--output", help="save the results as JSON")
+    parser.add_argument("--baseline", help="compare against results saved by --output")
+    parser.add_argument("--threshold", type=float, default=10, help="slowdown against the baseline reported as a regression, in percent")
+    arguments = parser.parse_args()
+
+    baseline = {}
+
+    if arguments.baseline:
+        with open(arguments.baseline) as file:
+            baseline = json.load(file)["results"]
+
+    results = {}
+    flagged = 0
+
+    for axis in arguments.axes.split(","):
+        if axis not in AXES:
+            print(f"Unknown axis: {axis}, available axes: {', '.join(AXES)}", file=sys.stderr)
+            return 1
+
+        generate, sizes = AXES[axis]
+        results[axis] = {}
+
+        print(f"{axis}")
+        print(f"  {'size':>6} {'wall':>9} {'rss':>9} {'growth':>7}  " + " ".join(f"{phase:>12}" for phase in PHASES))
+
+        previous = None
+
+        for size in sizes:
+            with tempfile.TemporaryDirectory() as directory:
+                entry = generate(directory, size)
+                result = build(arguments.sand, entry, os.path.join(directory, "output"), arguments.optimization_level)
+
+            if result is None:
+                flagged += 1
+                continue
+
+            results[axis][str(size)] = result
+
+            growth = exponent(previous[1]["wall"], result["wall"], previous[0], size) if previous else None
+            notes = []
+
+            if growth is not None and growth > arguments.exponent:
+                notes.append("super-linear")
+                flagged += 1
+
+            base = baseline.get(axis, {}).get(str(size))
+
+            if base is not None:
+                change = (result["wall"] / base["wall"] - 1) * 100
+
+                notes.append(f"{change:+.1f}% wall, {(result['rss'] / base['rss'] - 1) * 100:+.1f}% rss")
+
+                if change > arguments.threshold:
+                    notes.append("regression")
+                    flagged += 1
+
+            print(
+                f"  {size:>6} {result['wall']:>8.2f}s {result['rss'] / 1024:>7.1f}MB {growth if growth is not None else 0:>7.2f}  "
+                + " ".join(f"{result['phases'].get(phase, 0):>10.1f}ms" for phase in PHASES)
+                + ("  " + ", ".join(notes) if notes else "")
+            )
+
+            previous = (size, result)
+
+        print()
+
+    if arguments.output:
+        with open(arguments.output, "w") as file:
+            json.dump({"version": 1, "optimization_level": arguments.optimization_level, "results": results}, file, indent=2)
+
+    return 1 if flagged else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
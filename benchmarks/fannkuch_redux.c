@@ -0,0 +1,99 @@
+// fannkuch-redux, same program as fannkuch_redux.sn
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char **argv)
+{
+    long n = argc > 1 ? atol(argv[1]) : 10;
+
+    long *perm = calloc(n, sizeof(long));
+    long *perm1 = calloc(n, sizeof(long));
+    long *count = calloc(n, sizeof(long));
+
+    long max_flips = 0;
+    long checksum = 0;
+    long permutations = 0;
+    long r = n;
+
+    for (long i = 0; i < n; i++)
+    {
+        perm1[i] = i;
+    }
+
+    while (1)
+    {
+        while (r != 1)
+        {
+            count[r - 1] = r;
+            r--;
+        }
+
+        for (long i = 0; i < n; i++)
+        {
+            perm[i] = perm1[i];
+        }
+
+        long flips = 0;
+        long k = perm[0];
+
+        while (k != 0)
+        {
+            for (long low = 0, high = k; low < high; low++, high--)
+            {
+                long swap = perm[low];
+                perm[low] = perm[high];
+                perm[high] = swap;
+            }
+
+            flips++;
+            k = perm[0];
+        }
+
+        if (flips > max_flips)
+        {
+            max_flips = flips;
+        }
+
+        checksum += permutations % 2 == 0 ? flips : -flips;
+
+        // Next permutation, rotating the first r + 1 elements
+        int done = 1;
+
+        while (r != n)
+        {
+            long first = perm1[0];
+
+            for (long i = 0; i < r; i++)
+            {
+                perm1[i] = perm1[i + 1];
+            }
+
+            perm1[r] = first;
+            count[r]--;
+
+            if (count[r] > 0)
+            {
+                done = 0;
+                break;
+            }
+
+            r++;
+        }
+
+        if (done)
+        {
+            break;
+        }
+
+        permutations++;
+    }
+
+    printf("%ld\n%ld\n", checksum, max_flips);
+
+    free(perm);
+    free(perm1);
+    free(count);
+
+    return 0;
+}
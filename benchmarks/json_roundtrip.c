@@ -0,0 +1,193 @@
+// JSON round-trip, same program as json_roundtrip.sn: the objects are written with their keys in the order
+// std/json.sn stringifies them, and parsed back with a small recursive descent parser
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct buffer
+{
+    char *data;
+    size_t length;
+    size_t capacity;
+};
+
+static void append(struct buffer *buffer, const char *str)
+{
+    size_t length = strlen(str);
+
+    if (buffer->length + length + 1 > buffer->capacity)
+    {
+        buffer->capacity = (buffer->length + length + 1) * 2;
+        buffer->data = realloc(buffer->data, buffer->capacity);
+    }
+
+    memcpy(buffer->data + buffer->length, str, length + 1);
+    buffer->length += length;
+}
+
+// Twice the "id" plus the "active" member of every object, as in the Sand program
+static long checksum;
+
+static int parse_string(const char **str, char *out, size_t size)
+{
+    size_t length = 0;
+
+    if (**str != '"')
+    {
+        return 0;
+    }
+
+    (*str)++;
+
+    while (**str != '"')
+    {
+        if (**str == 0)
+        {
+            return 0;
+        }
+
+        if (**str == '\\')
+        {
+            (*str)++;
+        }
+
+        if (length + 1 < size)
+        {
+            out[length++] = **str;
+        }
+
+        (*str)++;
+    }
+
+    out[length] = 0;
+    (*str)++;
+
+    return 1;
+}
+
+static int parse_value(const char **str, const char *key)
+{
+    if (**str == '{')
+    {
+        (*str)++;
+
+        while (**str != '}')
+        {
+            char name[64];
+
+            if (!parse_string(str, name, sizeof(name)) || **str != ':')
+            {
+                return 0;
+            }
+
+            (*str)++;
+
+            if (!parse_value(str, name))
+            {
+                return 0;
+            }
+
+            if (**str == ',')
+            {
+                (*str)++;
+            }
+        }
+
+        (*str)++;
+    }
+    else if (**str == '[')
+    {
+        (*str)++;
+
+        while (**str != ']')
+        {
+            if (!parse_value(str, NULL))
+            {
+                return 0;
+            }
+
+            if (**str == ',')
+            {
+                (*str)++;
+            }
+        }
+
+        (*str)++;
+    }
+    else if (**str == '"')
+    {
+        char value[64];
+        return parse_string(str, value, sizeof(value));
+    }
+    else if (**str == '-' || (**str >= '0' && **str <= '9'))
+    {
+        char *end;
+        long value = strtol(*str, &end, 10);
+        *str = end;
+
+        if (key != NULL && strcmp(key, "id") == 0)
+        {
+            checksum += value * 2;
+        }
+        else if (key != NULL && strcmp(key, "active") == 0)
+        {
+            checksum += value;
+        }
+    }
+    else
+    {
+        return 0;
+    }
+
+    return 1;
+}
+
+static int round_trip(long items, long *length)
+{
+    struct buffer text = {NULL, 0, 0};
+    char item[128];
+
+    append(&text, "[");
+
+    for (long i = 0; i < items; i++)
+    {
+        snprintf(item, sizeof(item), "{\"active\":%ld,\"name\":\"item\",\"id\":%ld}", i % 2, i);
+
+        append(&text, item);
+
+        if (i + 1 < items)
+        {
+            append(&text, ",");
+        }
+    }
+
+    append(&text, "]");
+    *length += text.length;
+
+    const char *str = text.data;
+    int success = parse_value(&str, NULL) && *str == 0;
+
+    free(text.data);
+
+    return success;
+}
+
+int main(int argc, char **argv)
+{
+    long rounds = argc > 1 ? atol(argv[1]) : 4;
+    long length = 0;
+
+    for (long i = 0; i < rounds; i++)
+    {
+        if (!round_trip(50, &length))
+        {
+            printf("error\n");
+            break;
+        }
+    }
+
+    printf("%ld\n%ld\n", checksum, length);
+
+    return 0;
+}
@@ -0,0 +1,54 @@
+// mandelbrot, same program as mandelbrot.sn
+
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char **argv)
+{
+    long size = argc > 1 ? atol(argv[1]) : 2000;
+    long checksum = 0;
+
+    for (long y = 0; y < size; y++)
+    {
+        double ci = 2.0 * (double)y / (double)size - 1.0;
+        long bits = 0;
+
+        for (long x = 0; x < size;)
+        {
+            double cr = 2.0 * (double)x / (double)size - 1.5;
+            double zr = 0, zi = 0, tr = 0, ti = 0;
+
+            for (int i = 0; i < 50 && tr + ti <= 4.0; i++)
+            {
+                zi = 2.0 * zr * zi + ci;
+                zr = tr - ti + cr;
+                tr = zr * zr;
+                ti = zi * zi;
+            }
+
+            bits = bits << 1;
+
+            if (tr + ti <= 4.0)
+            {
+                bits = bits | 1;
+            }
+
+            x++;
+
+            if (x % 8 == 0 || x == size)
+            {
+                if (x % 8 != 0)
+                {
+                    bits = bits << (8 - x % 8);
+                }
+
+                checksum = (checksum * 31 + bits) % 1000000007;
+                bits = 0;
+            }
+        }
+    }
+
+    printf("%ld\n", checksum);
+
+    return 0;
+}
@@ -0,0 +1,131 @@
+// n-body, same program as nbody.sn
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define PI 3.141592653589793
+#define SOLAR_MASS (4 * PI * PI)
+#define DAYS_PER_YEAR 365.24
+
+static double bodies[5 * 7];
+
+static void set_body(int i, double x, double y, double z, double vx, double vy, double vz, double mass)
+{
+    double *body = bodies + i * 7;
+
+    body[0] = x;
+    body[1] = y;
+    body[2] = z;
+    body[3] = vx * DAYS_PER_YEAR;
+    body[4] = vy * DAYS_PER_YEAR;
+    body[5] = vz * DAYS_PER_YEAR;
+    body[6] = mass * SOLAR_MASS;
+}
+
+static void create_bodies(void)
+{
+    set_body(0, 0, 0, 0, 0, 0, 0, 1);
+    set_body(1, 4.84143144246472090, -1.16032004402742839, -0.103622044471123109, 0.00166007664274403694, 0.00769901118419740425, -0.0000690460016972063023, 0.000954791938424326609);
+    set_body(2, 8.34336671824457987, 4.12479856412430479, -0.403523417114321381, -0.00276742510726862411, 0.00499852801234917238, 0.0000230417297573763929, 0.000285885980666130812);
+    set_body(3, 12.8943695621391310, -15.1111514016986312, -0.223307578892655734, 0.00296460137564761618, 0.00237847173959480950, -0.0000296589568540237556, 0.0000436624404335156298);
+    set_body(4, 15.3796971148509165, -25.9193146099879641, 0.179258772950371181, 0.00268067772490389322, 0.00162824170038242295, -0.0000951592254519715870, 0.0000515138902046611451);
+}
+
+static void offset_momentum(void)
+{
+    double px = 0, py = 0, pz = 0;
+
+    for (int i = 0; i < 5; i++)
+    {
+        double *body = bodies + i * 7;
+
+        px += body[3] * body[6];
+        py += body[4] * body[6];
+        pz += body[5] * body[6];
+    }
+
+    bodies[3] = 0 - px / SOLAR_MASS;
+    bodies[4] = 0 - py / SOLAR_MASS;
+    bodies[5] = 0 - pz / SOLAR_MASS;
+}
+
+static double energy(void)
+{
+    double e = 0;
+
+    for (int i = 0; i < 5; i++)
+    {
+        double *a = bodies + i * 7;
+
+        e += 0.5 * a[6] * (a[3] * a[3] + a[4] * a[4] + a[5] * a[5]);
+
+        for (int j = i + 1; j < 5; j++)
+        {
+            double *b = bodies + j * 7;
+
+            double dx = a[0] - b[0];
+            double dy = a[1] - b[1];
+            double dz = a[2] - b[2];
+
+            e -= (a[6] * b[6]) / sqrt(dx * dx + dy * dy + dz * dz);
+        }
+    }
+
+    return e;
+}
+
+static void advance(double dt)
+{
+    for (int i = 0; i < 5; i++)
+    {
+        double *a = bodies + i * 7;
+
+        for (int j = i + 1; j < 5; j++)
+        {
+            double *b = bodies + j * 7;
+
+            double dx = a[0] - b[0];
+            double dy = a[1] - b[1];
+            double dz = a[2] - b[2];
+
+            double distance2 = dx * dx + dy * dy + dz * dz;
+            double magnitude = dt / (distance2 * sqrt(distance2));
+
+            a[3] -= dx * b[6] * magnitude;
+            a[4] -= dy * b[6] * magnitude;
+            a[5] -= dz * b[6] * magnitude;
+
+            b[3] += dx * a[6] * magnitude;
+            b[4] += dy * a[6] * magnitude;
+            b[5] += dz * a[6] * magnitude;
+        }
+    }
+
+    for (int i = 0; i < 5; i++)
+    {
+        double *body = bodies + i * 7;
+
+        body[0] += dt * body[3];
+        body[1] += dt * body[4];
+        body[2] += dt * body[5];
+    }
+}
+
+int main(int argc, char **argv)
+{
+    long steps = argc > 1 ? atol(argv[1]) : 1000000;
+
+    create_bodies();
+    offset_momentum();
+    printf("%ld\n", (long)(energy() * 1000000000.0));
+
+    for (long i = 0; i < steps; i++)
+    {
+        advance(0.01);
+    }
+
+    printf("%ld\n", (long)(energy() * 1000000000.0));
+
+    return 0;
+}
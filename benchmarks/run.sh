@@ -0,0 +1,135 @@
+#!/bin/bash
+
+# Builds every benchmark with sand at each optimization level and its C reference with clang,
+# then prints the runtime and peak RSS of the Sand programs as ratios of the C ones (lower is better).
+#
+# Environment:
+#   SAND     sand executable (bin/sand)
+#   CC       C compiler (clang)
+#   CFLAGS   flags of the C references (-O2)
+#   LEVELS   sand optimization levels ("0 g 1 2 3 s z")
+#   RUNS     runs of each program, the fastest one is kept (3)
+#
+# Arguments are the benchmarks to run, all of them by default.
+
+script_directory="$( cd "$( dirname "${BASH_SOURCE[0]}" )" >/dev/null 2>&1 && pwd )"
+
+sand=${SAND:-$script_directory/../bin/sand}
+cc=${CC:-clang}
+cflags=${CFLAGS:--O2}
+levels=${LEVELS:-0 g 1 2 3 s z}
+runs=${RUNS:-3}
+
+# Size of each benchmark, given as its first argument
+declare -A sizes=(
+    [binary_trees]=16
+    [fannkuch_redux]=10
+    [json_roundtrip]=4
+    [mandelbrot]=2000
+    [nbody]=1000000
+    [spectral_norm]=2000
+    [vec_map_churn]=100
+)
+
+if [ ! -x "$sand" ]; then
+    echo "sand not found at $sand, build it or set SAND" >&2
+    exit 1
+fi
+
+if ! command -v "$cc" >/dev/null 2>&1; then
+    echo "$cc not found, install it or set CC" >&2
+    exit 1
+fi
+
+if [ ! -x /usr/bin/time ]; then
+    echo "/usr/bin/time is required to measure the peak RSS" >&2
+    exit 1
+fi
+
+if [ $# -gt 0 ]; then
+    benchmarks="$*"
+else
+    benchmarks=$(echo "${!sizes[@]}" | tr ' ' '\n' | sort)
+fi
+
+build_directory=$(mktemp -d)
+trap 'rm -rf "$build_directory"' EXIT
+
+# Prints "<seconds> <max RSS in KB>" of the fastest run, the program output is written to $2
+measure() {
+    local program=$1
+    local output=$2
+    local size=$3
+    local best=""
+
+    for ((run = 0; run < runs; run++)); do
+        if ! /usr/bin/time -f "%e %M" -o "$build_directory/time" "$program" $size > "$output"; then
+            echo "failed"
+            return
+        fi
+
+        local current=$(cat "$build_directory/time")
+
+        if [ -z "$best" ] || awk -v a="${current% *}" -v b="${best% *}" 'BEGIN { exit !(a < b) }'; then
+            best=$current
+        fi
+    done
+
+    echo "$best"
+}
+
+ratio() {
+    awk -v a="$1" -v b="$2" 'BEGIN { if (b > 0) printf "%.2f", a / b; else printf "-" }'
+}
+
+printf "%-16s %10s %10s" "benchmark" "C time" "C RSS"
+
+for level in $levels; do
+    printf " %14s" "O$level time/RSS"
+done
+
+printf "\n"
+
+for benchmark in $benchmarks; do
+    size=${sizes[$benchmark]}
+
+    if [ -z "$size" ]; then
+        echo "Unknown benchmark: $benchmark" >&2
+        continue
+    fi
+
+    if ! $cc $cflags -o "$build_directory/$benchmark.c.out" "$script_directory/$benchmark.c" -lm; then
+        echo "Could not compile $benchmark.c" >&2
+        continue
+    fi
+
+    reference=$(measure "$build_directory/$benchmark.c.out" "$build_directory/$benchmark.c.txt" "$size")
+
+    if [ "$reference" = "failed" ]; then
+        echo "$benchmark.c failed" >&2
+        continue
+    fi
+
+    printf "%-16s %9ss %8sKB" "$benchmark" "${reference% *}" "${reference#* }"
+
+    for level in $levels; do
+        program="$build_directory/$benchmark.O$level.out"
+
+        if ! "$sand" build -O "$level" -o "$program" "$script_directory/$benchmark.sn" > "$build_directory/build.log" 2>&1; then
+            printf " %14s" "build error"
+            continue
+        fi
+
+        result=$(measure "$program" "$build_directory/$benchmark.O$level.txt" "$size")
+
+        if [ "$result" = "failed" ]; then
+            printf " %14s" "failed"
+        elif ! cmp -s "$build_directory/$benchmark.c.txt" "$build_directory/$benchmark.O$level.txt"; then
+            printf " %14s" "wrong output"
+        else
+            printf " %14s" "$(ratio "${result% *}" "${reference% *}")/$(ratio "${result#* }" "${reference#* }")"
+        fi
+    done
+
+    printf "\n"
+done
@@ -0,0 +1,82 @@
+// spectral-norm, same program as spectral_norm.sn
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static double a(long i, long j)
+{
+    return 1.0 / (double)((i + j) * (i + j + 1) / 2 + i + 1);
+}
+
+static void multiply_av(long n, const double *v, double *av)
+{
+    for (long i = 0; i < n; i++)
+    {
+        double sum = 0;
+
+        for (long j = 0; j < n; j++)
+        {
+            sum += a(i, j) * v[j];
+        }
+
+        av[i] = sum;
+    }
+}
+
+static void multiply_atv(long n, const double *v, double *atv)
+{
+    for (long i = 0; i < n; i++)
+    {
+        double sum = 0;
+
+        for (long j = 0; j < n; j++)
+        {
+            sum += a(j, i) * v[j];
+        }
+
+        atv[i] = sum;
+    }
+}
+
+static void multiply_atav(long n, const double *v, double *atav, double *tmp)
+{
+    multiply_av(n, v, tmp);
+    multiply_atv(n, tmp, atav);
+}
+
+int main(int argc, char **argv)
+{
+    long n = argc > 1 ? atol(argv[1]) : 2000;
+
+    double *u = calloc(n, sizeof(double));
+    double *v = calloc(n, sizeof(double));
+    double *tmp = calloc(n, sizeof(double));
+
+    for (long i = 0; i < n; i++)
+    {
+        u[i] = 1;
+    }
+
+    for (int i = 0; i < 10; i++)
+    {
+        multiply_atav(n, u, v, tmp);
+        multiply_atav(n, v, u, tmp);
+    }
+
+    double vbv = 0, vv = 0;
+
+    for (long i = 0; i < n; i++)
+    {
+        vbv += u[i] * v[i];
+        vv += v[i] * v[i];
+    }
+
+    printf("%ld\n", (long)(sqrt(vbv / vv) * 1000000000.0));
+
+    free(u);
+    free(v);
+    free(tmp);
+
+    return 0;
+}
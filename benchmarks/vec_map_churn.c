@@ -0,0 +1,108 @@
+// Vec and Map churn, same program as vec_map_churn.sn with the same data structures as std/vec.sn and std/map.sn:
+// a vector growing to (capacity + 1) * 2, and a map as a linked list of pairs, inserted first
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct vec
+{
+    long *ptr;
+    unsigned long capacity;
+    unsigned long length;
+};
+
+static void vec_push(struct vec *vec, long value)
+{
+    if (vec->length == vec->capacity)
+    {
+        vec->capacity = (vec->capacity + 1) * 2;
+        long *copy = calloc(vec->capacity, sizeof(long));
+
+        if (vec->ptr != NULL)
+        {
+            memcpy(copy, vec->ptr, vec->length * sizeof(long));
+            free(vec->ptr);
+        }
+
+        vec->ptr = copy;
+    }
+
+    vec->ptr[vec->length++] = value;
+}
+
+static long vec_pop(struct vec *vec)
+{
+    return vec->ptr[--vec->length];
+}
+
+struct node
+{
+    long key;
+    long *value;
+    struct node *next;
+};
+
+static void map_insert(struct node **first, long key, long value)
+{
+    struct node *node = calloc(1, sizeof(struct node));
+
+    node->key = key;
+    node->value = calloc(1, sizeof(long));
+    *node->value = value;
+    node->next = *first;
+
+    *first = node;
+}
+
+static long map_get(struct node *node, long key)
+{
+    while (node != NULL)
+    {
+        if (node->key == key)
+        {
+            return *node->value;
+        }
+
+        node = node->next;
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    long rounds = argc > 1 ? atol(argv[1]) : 100;
+    long checksum = 0;
+
+    struct vec values = {NULL, 0, 0};
+
+    for (long round = 0; round < rounds; round++)
+    {
+        for (long i = 0; i < 100000; i++)
+        {
+            vec_push(&values, i * round);
+        }
+
+        while (values.length > 0)
+        {
+            checksum = (checksum + vec_pop(&values) % 7) % 1000000007;
+        }
+    }
+
+    struct node *map = NULL;
+
+    for (long key = 0; key < 1000; key++)
+    {
+        map_insert(&map, key, key * 3);
+    }
+
+    for (long j = 0; j < rounds * 1000; j++)
+    {
+        checksum = (checksum + map_get(map, j % 1000)) % 1000000007;
+    }
+
+    printf("%ld\n", checksum);
+
+    return 0;
+}
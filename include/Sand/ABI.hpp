@@ -0,0 +1,348 @@
+#pragma once
+
+#include <Sand/Type.hpp>
+
+#include <llvm/ADT/Triple.h>
+#include <llvm/IR/DataLayout.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/Module.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace Sand
+{
+enum class ABIKind
+{
+    // Passed as is
+    Direct,
+    // Passed in registers as `coerced_type`
+    Coerced,
+    // Passed through a pointer (sret for return values)
+    Indirect,
+};
+
+struct ABIInfo
+{
+    ABIKind kind = ABIKind::Direct;
+    llvm::Type *coerced_type = nullptr;
+    bool is_byval = false;
+
+    ABIInfo(const ABIKind &kind_ = ABIKind::Direct, llvm::Type *coerced_type_ = nullptr, const bool &is_byval_ = false) : kind(kind_), coerced_type(coerced_type_), is_byval(is_byval_) {}
+};
+
+class ABI
+{
+private:
+    enum class Class
+    {
+        None,
+        Integer,
+        SSE,
+        Memory,
+    };
+
+    struct Eightbyte
+    {
+        Class type = Class::None;
+        bool has_double = false;
+        uint64_t end = 0;
+    };
+
+    static constexpr unsigned SYSV_INTEGER_REGISTERS = 6;
+    static constexpr unsigned SYSV_SSE_REGISTERS = 8;
+
+    static Class merge(const Class &left, const Class &right)
+    {
+        if (left == right || right == Class::None)
+            return left;
+
+        if (left == Class::None)
+            return right;
+
+        if (left == Class::Memory || right == Class::Memory)
+            return Class::Memory;
+
+        return Class::Integer;
+    }
+
+    static void classify(llvm::Type *type, const uint64_t &offset, const llvm::DataLayout &layout, Eightbyte eightbytes[2])
+    {
+        if (auto struct_type = llvm::dyn_cast<llvm::StructType>(type))
+        {
+            auto struct_layout = layout.getStructLayout(struct_type);
+
+            for (unsigned i = 0; i < struct_type->getNumElements(); i++)
+            {
+                auto element = struct_type->getElementType(i);
+                auto element_offset = offset + struct_layout->getElementOffset(i);
+
+                // Unaligned fields of packed classes are always passed in memory
+                if (element_offset % layout.getABITypeAlignment(element) != 0)
+                {
+                    eightbytes[0].type = eightbytes[1].type = Class::Memory;
+                    return;
+                }
+
+                classify(element, element_offset, layout, eightbytes);
+            }
+
+            return;
+        }
+
+        if (auto array_type = llvm::dyn_cast<llvm::ArrayType>(type))
+        {
+            auto element = array_type->getElementType();
+            auto element_size = layout.getTypeAllocSize(element);
+
+            for (uint64_t i = 0; i < array_type->getNumElements(); i++)
+            {
+                classify(element, offset + i * element_size, layout, eightbytes);
+            }
+
+            return;
+        }
+
+        auto size = layout.getTypeStoreSize(type);
+
+        if (size == 0)
+            return;
+
+        auto index = offset / 8;
+
+        if (index > 1 || (offset + size - 1) / 8 != index)
+        {
+            eightbytes[0].type = eightbytes[1].type = Class::Memory;
+            return;
+        }
+
+        auto &eightbyte = eightbytes[index];
+        eightbyte.end = std::max<uint64_t>(eightbyte.end, offset + size - index * 8);
+
+        if (type->isIntegerTy() || type->isPointerTy())
+        {
+            eightbyte.type = merge(eightbyte.type, Class::Integer);
+        }
+        else if (type->isFloatTy() || type->isDoubleTy())
+        {
+            eightbyte.type = merge(eightbyte.type, Class::SSE);
+            eightbyte.has_double |= type->isDoubleTy();
+        }
+        else
+        {
+            eightbyte.type = merge(eightbyte.type, Class::Memory);
+        }
+    }
+
+    static llvm::Type *eightbyte_type(const Eightbyte &eightbyte, llvm::LLVMContext &context)
+    {
+        if (eightbyte.type == Class::SSE)
+        {
+            if (eightbyte.has_double)
+                return llvm::Type::getDoubleTy(context);
+
+            if (eightbyte.end <= 4)
+                return llvm::Type::getFloatTy(context);
+
+            return llvm::VectorType::get(llvm::Type::getFloatTy(context), 2);
+        }
+
+        return llvm::IntegerType::get(context, eightbyte.end * 8);
+    }
+
+    /**
+     * Classify a struct following the System V AMD64 ABI.
+     * Return a Coerced info with the registers needed, or an Indirect one when the struct lives in memory.
+     */
+    static ABIInfo classify_sysv(Type *type, const llvm::DataLayout &layout, unsigned &integer_registers, unsigned &sse_registers)
+    {
+        auto size = layout.getTypeAllocSize(type->get_ref());
+
+        if (size > 16)
+            return ABIInfo(ABIKind::Indirect);
+
+        Eightbyte eightbytes[2];
+        classify(type->get_ref(), 0, layout, eightbytes);
+
+        auto count = (size + 7) / 8;
+
+        integer_registers = 0;
+        sse_registers = 0;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            auto &eightbyte = eightbytes[i];
+
+            if (eightbyte.type == Class::Memory)
+                return ABIInfo(ABIKind::Indirect);
+
+            if (eightbyte.type == Class::None)
+            {
+                eightbyte.type = Class::Integer;
+                eightbyte.end = std::min<uint64_t>(8, size - i * 8);
+            }
+
+            if (eightbyte.type == Class::SSE)
+                sse_registers++;
+            else
+                integer_registers++;
+        }
+
+        auto &context = type->get_ref()->getContext();
+
+        if (count == 1)
+            return ABIInfo(ABIKind::Coerced, eightbyte_type(eightbytes[0], context));
+
+        auto coerced_type = llvm::StructType::get(context, {eightbyte_type(eightbytes[0], context), eightbyte_type(eightbytes[1], context)});
+        return ABIInfo(ABIKind::Coerced, coerced_type);
+    }
+
+    /**
+     * Classify a struct following the Microsoft x64 calling convention.
+     * Only structs of 1, 2, 4 or 8 bytes are passed in a register.
+     */
+    static ABIInfo classify_win64(Type *type, const llvm::DataLayout &layout)
+    {
+        auto size = layout.getTypeAllocSize(type->get_ref());
+
+        if (size == 1 || size == 2 || size == 4 || size == 8)
+        {
+            return ABIInfo(ABIKind::Coerced, llvm::IntegerType::get(type->get_ref()->getContext(), size * 8));
+        }
+
+        return ABIInfo(ABIKind::Indirect);
+    }
+
+    static bool is_classifiable_struct(Type *type)
+    {
+        if (!type->is_struct() || type->is_opaque())
+            return false;
+
+        return llvm::cast<llvm::StructType>(type->get_ref())->isSized();
+    }
+
+public:
+    static ABIInfo classify_return(Type *type, std::unique_ptr<llvm::Module> &module)
+    {
+        auto &layout = module->getDataLayout();
+        llvm::Triple triple(module->getTargetTriple());
+
+        if (type->is_void())
+            return ABIInfo();
+
+        if (triple.getArch() == llvm::Triple::x86_64 && is_classifiable_struct(type))
+        {
+            if (layout.getTypeAllocSize(type->get_ref()) == 0)
+                return ABIInfo(ABIKind::Indirect);
+
+            if (triple.isOSWindows())
+                return classify_win64(type, layout);
+
+            unsigned integer_registers, sse_registers;
+            return classify_sysv(type, layout, integer_registers, sse_registers);
+        }
+
+        if (type->is_struct() || type->size(module) > 8)
+            return ABIInfo(ABIKind::Indirect);
+
+        return ABIInfo();
+    }
+
+    static std::vector<ABIInfo> classify_arguments(const std::vector<Type *> &types, const ABIInfo &return_info, std::unique_ptr<llvm::Module> &module)
+    {
+        auto &layout = module->getDataLayout();
+        llvm::Triple triple(module->getTargetTriple());
+
+        std::vector<ABIInfo> infos;
+
+        if (triple.getArch() != llvm::Triple::x86_64)
+        {
+            infos.resize(types.size());
+            return infos;
+        }
+
+        auto is_windows = triple.isOSWindows();
+
+        unsigned free_integer_registers = SYSV_INTEGER_REGISTERS - (return_info.kind == ABIKind::Indirect ? 1 : 0);
+        unsigned free_sse_registers = SYSV_SSE_REGISTERS;
+
+        for (const auto &type : types)
+        {
+            if (!is_classifiable_struct(type) || layout.getTypeAllocSize(type->get_ref()) == 0)
+            {
+                if (type->is_floating_point())
+                {
+                    free_sse_registers -= std::min(free_sse_registers, 1U);
+                }
+                else
+                {
+                    free_integer_registers -= std::min(free_integer_registers, 1U);
+                }
+
+                infos.push_back(ABIInfo());
+                continue;
+            }
+
+            if (is_windows)
+            {
+                infos.push_back(classify_win64(type, layout));
+                continue;
+            }
+
+            unsigned integer_registers, sse_registers;
+            auto info = classify_sysv(type, layout, integer_registers, sse_registers);
+
+            // A struct is either passed entirely in registers or entirely on the stack
+            if (info.kind == ABIKind::Coerced && (integer_registers > free_integer_registers || sse_registers > free_sse_registers))
+            {
+                info = ABIInfo(ABIKind::Indirect);
+            }
+
+            if (info.kind == ABIKind::Coerced)
+            {
+                free_integer_registers -= integer_registers;
+                free_sse_registers -= sse_registers;
+            }
+            else
+            {
+                info.is_byval = true;
+            }
+
+            infos.push_back(info);
+        }
+
+        return infos;
+    }
+
+    /**
+     * Load the struct stored at `address` as its coerced type
+     */
+    static llvm::Value *coerce(llvm::Value *address, Type *type, llvm::Type *coerced_type, llvm::IRBuilder<> &builder, std::unique_ptr<llvm::Module> &module)
+    {
+        auto &layout = module->getDataLayout();
+
+        auto size = std::min(layout.getTypeAllocSize(type->get_ref()), layout.getTypeAllocSize(coerced_type));
+        auto coerced = builder.CreateAlloca(coerced_type, nullptr, "coerce");
+
+        builder.CreateMemCpy(coerced, llvm::MaybeAlign(layout.getABITypeAlignment(coerced_type)), address, llvm::MaybeAlign(layout.getABITypeAlignment(type->get_ref())), size);
+
+        return builder.CreateLoad(coerced);
+    }
+
+    /**
+     * Store a coerced value into the struct at `address`
+     */
+    static void uncoerce(llvm::Value *value, llvm::Value *address, Type *type, llvm::IRBuilder<> &builder, std::unique_ptr<llvm::Module> &module)
+    {
+        auto &layout = module->getDataLayout();
+
+        auto coerced_type = value->getType();
+        auto size = std::min(layout.getTypeAllocSize(type->get_ref()), layout.getTypeAllocSize(coerced_type));
+        auto coerced = builder.CreateAlloca(coerced_type, nullptr, "coerce");
+
+        builder.CreateStore(value, coerced);
+        builder.CreateMemCpy(address, llvm::MaybeAlign(layout.getABITypeAlignment(type->get_ref())), coerced, llvm::MaybeAlign(layout.getABITypeAlignment(coerced_type)), size);
+    }
+};
+} // namespace Sand
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(__linux__) && defined(__x86_64__)
+    #define SAND_HAS_BENCH
+#endif
+
+namespace Sand
+{
+/**
+ * Timings of a `#[bench]` function, per iteration
+ */
+struct Benchmark
+{
+    std::string name;
+
+    uint64_t samples = 0;
+    uint64_t iterations = 0;
+
+    // Nanoseconds
+    double mean = 0;
+    double median = 0;
+    double p99 = 0;
+
+    // Timestamp counter cycles and allocations, averaged over every iteration
+    double cycles = 0;
+    double allocations = 0;
+};
+
+struct BenchmarkResult
+{
+    bool success = false;
+    std::string errors;
+
+    std::vector<Benchmark> benchmarks;
+};
+
+/**
+ * Statistics of the samples written by the std runtime (std/bench.sn), compared against a JSON baseline
+ */
+class Benchmarks
+{
+public:
+    static BenchmarkResult read(const std::string &samples_file);
+
+    static BenchmarkResult read_baseline(const std::string &baseline_file);
+
+    static bool write_baseline(const std::string &baseline_file, const std::vector<Benchmark> &benchmarks, std::string &errors);
+
+    /**
+     * A table of the benchmarks, with the change of their median against the baseline when it has them.
+     * `regressions` counts the medians slower than the baseline by more than `threshold` (a ratio).
+     */
+    static std::string report(const std::vector<Benchmark> &benchmarks, const std::vector<Benchmark> &baseline, const double &threshold, unsigned &regressions);
+};
+} // namespace Sand
@@ -2,6 +2,8 @@
 
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/ToolOutputFile.h>
 #include <llvm/Target/TargetMachine.h>
 
 #include <memory>
@@ -16,9 +18,90 @@ private:
     std::unique_ptr<llvm::Module> &module;
     llvm::TargetMachine *target_machine = nullptr;
 
+    // -Og selects the instructions with a copy of the target machine, the one given may be shared (Session)
+    std::unique_ptr<llvm::TargetMachine> fast_target_machine;
+
 public:
+    // Instrument the code to write a raw profile (.profraw) at exit, through the std runtime
+    bool profile_generate = false;
+
+    // Indexed profile (.profdata) guiding the optimizations
+    std::string profile_use;
+
+    // XRay sleds in the functions of at least `xray_threshold` machine instructions, patched by the std runtime
+    bool xray = false;
+    unsigned xray_threshold = 200;
+
+    // Every function keeps its frame pointer, so profilers can walk the stack
+    bool frame_pointers = false;
+
+    // -Og: at O0, only promote the allocas to registers and simplify the control flow, then select the instructions with FastISel
+    bool fast_debug = false;
+
+    // Functions analyzed with llvm-mca, with the ones marked `#[analyze]`, and the report written by `generate_objects`
+    std::vector<std::string> mca_functions;
+    std::string mca_report;
+
+    // Replace main with a driver timing the `#[bench]` functions whose name contains `bench_filter`, through the std runtime
+    bool bench = false;
+    std::string bench_filter;
+    std::vector<std::string> bench_functions;
+
+    // Sampled call trace (collapsed stacks or one symbol per line) ordering the functions
+    std::string call_trace;
+
+    // Written by `generate_objects` or `generate_bitcode` from the profile or the call trace, when the linker takes one (ELF)
+    bool order_symbols = false;
+    std::string symbol_ordering_file;
+
+    // Optimization remarks of the passes in `remarks_passes` (all of them if empty), as yaml or bitstream
+    std::string remarks_file;
+    std::string remarks_format = "yaml";
+    std::vector<std::string> remarks_passes;
+
     Compiler(std::unique_ptr<llvm::Module> &module_, llvm::TargetMachine *target_machine_) : module(module_), target_machine(target_machine_) {}
 
-    std::vector<std::string> generate_objects(const std::string &os, const std::string &arch, const llvm::PassBuilder::OptimizationLevel &optimization_level, const bool &verbose);
+    std::vector<std::string> generate_objects(const std::string &os, const std::string &arch, const llvm::PassBuilder::OptimizationLevel &optimization_level, const bool &verbose, const unsigned &jobs = 1);
+
+    std::unique_ptr<llvm::MemoryBuffer> generate_object_buffer(const llvm::PassBuilder::OptimizationLevel &optimization_level);
+
+    /**
+     * Generate a ThinLTO bitcode file: the module is only optimized locally and carries its summary
+     */
+    std::vector<std::string> generate_bitcode(const llvm::PassBuilder::OptimizationLevel &optimization_level, const bool &verbose);
+
+    /**
+     * Link ThinLTO bitcode files into native objects, one backend thread per module.
+     * Inputs that are not bitcode are returned as is.
+     */
+    std::vector<std::string> thin_link(const std::vector<std::string> &inputs, const llvm::PassBuilder::OptimizationLevel &optimization_level, const unsigned &jobs, const std::string &cache_directory);
+
+private:
+    void optimize(const llvm::PassBuilder::OptimizationLevel &optimization_level, const bool &verbose, const bool &thin_lto = false);
+
+    void instrument_xray();
+
+    void register_runtimes();
+
+    void select_fast_instructions();
+
+    bool generate_bench_driver();
+
+    std::vector<std::string> get_analyzed_functions() const;
+
+    void analyze_throughput(const llvm::PassBuilder::OptimizationLevel &optimization_level);
+
+    std::string get_remarks_passes() const;
+
+    std::unique_ptr<llvm::ToolOutputFile> open_remarks();
+
+    /**
+     * Split hot and cold functions and write the symbol ordering file, hottest functions first
+     */
+    void order_functions();
+
+    bool emit(llvm::raw_pwrite_stream &dest, const llvm::PassBuilder::OptimizationLevel &optimization_level, const llvm::CodeGenFileType &file_type = llvm::CGFT_ObjectFile);
+
+    std::vector<std::string> generate_objects_parallel(const llvm::PassBuilder::OptimizationLevel &optimization_level, const unsigned &jobs);
 };
 } // namespace Sand
@@ -0,0 +1,354 @@
+#pragma once
+
+#include <Sand/Type.hpp>
+#include <Sand/Types/ClassType.hpp>
+#include <Sand/Types/FunctionType.hpp>
+#include <Sand/Values/Function.hpp>
+#include <Sand/filesystem.hpp>
+
+#include "antlr4-runtime.h"
+
+#include <llvm/ADT/Triple.h>
+#include <llvm/BinaryFormat/Dwarf.h>
+#include <llvm/IR/DIBuilder.h>
+#include <llvm/IR/DebugInfoMetadata.h>
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/IntrinsicInst.h>
+#include <llvm/IR/Module.h>
+
+#include <map>
+#include <memory>
+
+namespace Sand
+{
+/**
+ * DWARF (or CodeView) description of the generated code, enabled with `-g`.
+ * Each source file gets its own compile unit, each function body its subprogram.
+ */
+class DebugInfo
+{
+private:
+    struct Unit
+    {
+        std::unique_ptr<llvm::DIBuilder> builder;
+        llvm::DIFile *file = nullptr;
+    };
+
+    std::unique_ptr<llvm::Module> &module;
+    bool is_optimized = false;
+
+    std::map<fs::path, Unit> units;
+    std::map<std::pair<llvm::Type *, bool>, llvm::DIType *> types;
+
+    Unit &get_unit(const fs::path &path)
+    {
+        auto it = this->units.find(path);
+
+        if (it != this->units.end())
+        {
+            return it->second;
+        }
+
+        Unit unit;
+        unit.builder = std::make_unique<llvm::DIBuilder>(*this->module);
+        unit.file = unit.builder->createFile(path.filename().u8string(), path.parent_path().u8string());
+
+        unit.builder->createCompileUnit(llvm::dwarf::DW_LANG_C, unit.file, "Sand compiler", this->is_optimized, "", 0);
+
+        return this->units.emplace(path, std::move(unit)).first->second;
+    }
+
+    llvm::DIType *get_class_type(Types::ClassType *type, Unit &unit)
+    {
+        auto &layout = this->module->getDataLayout();
+        auto struct_type = type->get_ref();
+        auto key = std::make_pair(static_cast<llvm::Type *>(struct_type), false);
+
+        if (struct_type->isOpaque())
+        {
+            auto declaration = unit.builder->createStructType(unit.file, type->name, unit.file, 0, 0, 0, llvm::DINode::FlagFwdDecl, nullptr, llvm::DINodeArray());
+            this->types[key] = declaration;
+
+            return declaration;
+        }
+
+        auto struct_layout = layout.getStructLayout(struct_type);
+        auto size = struct_layout->getSizeInBits();
+        auto align = layout.getABITypeAlignment(struct_type) * 8;
+
+        // Classes may point to themselves, their members refer to this placeholder until the class is complete
+        auto placeholder = unit.builder->createReplaceableCompositeType(llvm::dwarf::DW_TAG_structure_type, type->name, unit.file, unit.file, 0, 0, size, align);
+        this->types[key] = placeholder;
+
+        std::vector<llvm::Metadata *> elements;
+
+        for (size_t i = 0; i < struct_type->getNumElements(); i++)
+        {
+            auto offset = struct_layout->getElementOffsetInBits(i);
+
+            if (i < type->parents.size())
+            {
+                auto parent = this->get_class_type(type->parents[i], unit);
+                elements.push_back(unit.builder->createInheritance(placeholder, parent, offset, 0, llvm::DINode::FlagZero));
+                continue;
+            }
+
+            auto property_index = i - type->parents.size();
+
+            if (property_index >= type->properties.size())
+            {
+                break;
+            }
+
+            auto property = type->properties[property_index];
+            auto element = struct_type->getElementType(i);
+
+            elements.push_back(unit.builder->createMemberType(unit.file,
+                                                              property->name,
+                                                              unit.file,
+                                                              0,
+                                                              layout.getTypeSizeInBits(element),
+                                                              layout.getABITypeAlignment(element) * 8,
+                                                              offset,
+                                                              llvm::DINode::FlagZero,
+                                                              this->get_type(property->type, unit)));
+        }
+
+        auto complete = unit.builder->createStructType(unit.file, type->name, unit.file, 0, size, align, llvm::DINode::FlagZero, nullptr, unit.builder->getOrCreateArray(elements));
+        unit.builder->replaceTemporary(llvm::TempDICompositeType(placeholder), complete);
+
+        this->types[key] = complete;
+
+        return complete;
+    }
+
+    llvm::DIType *get_type(llvm::Type *type, const bool &is_signed, const std::string &name, Unit &unit)
+    {
+        auto key = std::make_pair(type, is_signed);
+        auto it = this->types.find(key);
+
+        if (it != this->types.end())
+        {
+            return it->second;
+        }
+
+        auto &layout = this->module->getDataLayout();
+        llvm::DIType *di_type = nullptr;
+
+        if (type->isIntegerTy(1))
+        {
+            di_type = unit.builder->createBasicType("bool", 8, llvm::dwarf::DW_ATE_boolean);
+        }
+        else if (type->isIntegerTy())
+        {
+            auto bits = type->getIntegerBitWidth();
+            auto default_name = (is_signed ? "i" : "u") + std::to_string(bits);
+
+            di_type = unit.builder->createBasicType(default_name, bits, is_signed ? llvm::dwarf::DW_ATE_signed : llvm::dwarf::DW_ATE_unsigned);
+        }
+        else if (type->isFloatingPointTy())
+        {
+            di_type = unit.builder->createBasicType(type->isFloatTy() ? "f32" : "f64", layout.getTypeSizeInBits(type), llvm::dwarf::DW_ATE_float);
+        }
+        else if (auto pointer_type = llvm::dyn_cast<llvm::PointerType>(type))
+        {
+            auto element = pointer_type->getElementType();
+            llvm::DIType *pointee = nullptr;
+
+            if (!element->isFunctionTy())
+            {
+                pointee = this->get_type(element, true, "", unit);
+            }
+
+            di_type = unit.builder->createPointerType(pointee, layout.getPointerSizeInBits());
+        }
+        else if (auto array_type = llvm::dyn_cast<llvm::ArrayType>(type))
+        {
+            auto element = array_type->getElementType();
+            auto subscript = unit.builder->getOrCreateSubrange(0, array_type->getNumElements());
+
+            di_type = unit.builder->createArrayType(layout.getTypeSizeInBits(type), layout.getABITypeAlignment(type) * 8, this->get_type(element, true, "", unit), unit.builder->getOrCreateArray({subscript}));
+        }
+        else if (auto struct_type = llvm::dyn_cast<llvm::StructType>(type))
+        {
+            // A struct that isn't a known class, its layout is unnamed
+            auto struct_name = struct_type->hasName() ? struct_type->getName().str() : name;
+            di_type = unit.builder->createStructType(unit.file, struct_name, unit.file, 0, 0, 0, llvm::DINode::FlagFwdDecl, nullptr, llvm::DINodeArray());
+        }
+
+        this->types[key] = di_type;
+
+        return di_type;
+    }
+
+    llvm::DIType *get_type(Type *type, Unit &unit)
+    {
+        if (type == nullptr || type->is_void())
+        {
+            return nullptr;
+        }
+
+        if (auto class_type = dynamic_cast<Types::ClassType *>(Type::get_origin(type)))
+        {
+            auto key = std::make_pair(static_cast<llvm::Type *>(class_type->get_ref()), false);
+            auto it = this->types.find(key);
+
+            if (it != this->types.end() && !(llvm::isa<llvm::DICompositeType>(it->second) && llvm::cast<llvm::DICompositeType>(it->second)->isForwardDecl() && !class_type->get_ref()->isOpaque()))
+            {
+                return it->second;
+            }
+
+            return this->get_class_type(class_type, unit);
+        }
+
+        if (type->is_pointer() && type->base != nullptr && !type->base->is_void() && !type->base->is_function())
+        {
+            return unit.builder->createPointerType(this->get_type(type->base, unit), this->module->getDataLayout().getPointerSizeInBits());
+        }
+
+        return this->get_type(type->get_ref(), type->is_signed, type->name, unit);
+    }
+
+public:
+    DebugInfo(std::unique_ptr<llvm::Module> &module_, const bool &is_optimized_ = false) : module(module_), is_optimized(is_optimized_)
+    {
+        llvm::Triple triple(this->module->getTargetTriple());
+
+        if (triple.isOSWindows())
+        {
+            this->module->addModuleFlag(llvm::Module::Warning, "CodeView", 1);
+        }
+        else
+        {
+            this->module->addModuleFlag(llvm::Module::Warning, "Dwarf Version", 4);
+        }
+
+        this->module->addModuleFlag(llvm::Module::Warning, "Debug Info Version", llvm::DEBUG_METADATA_VERSION);
+    }
+
+    llvm::DIType *get_type(Type *type, const fs::path &path)
+    {
+        return this->get_type(type, this->get_unit(path));
+    }
+
+    llvm::DISubprogram *create_function(Values::Function *function, const fs::path &path, const size_t &line)
+    {
+        auto &unit = this->get_unit(path);
+        auto function_type = function->get_type();
+
+        std::vector<llvm::Metadata *> types = {this->get_type(function_type->return_type, unit)};
+
+        for (const auto &arg : function_type->args)
+        {
+            types.push_back(this->get_type(arg.type, unit));
+        }
+
+        auto flags = llvm::DISubprogram::SPFlagDefinition;
+
+        if (this->is_optimized)
+        {
+            flags |= llvm::DISubprogram::SPFlagOptimized;
+        }
+
+        auto function_ref = function->get_ref();
+        auto linkage_name = function_ref->getName() != function_type->name ? function_ref->getName() : "";
+
+        auto subprogram = unit.builder->createFunction(unit.file,
+                                                       function_type->name,
+                                                       linkage_name,
+                                                       unit.file,
+                                                       line,
+                                                       unit.builder->createSubroutineType(unit.builder->getOrCreateTypeArray(types)),
+                                                       line,
+                                                       llvm::DINode::FlagPrototyped,
+                                                       flags);
+
+        function_ref->setSubprogram(subprogram);
+
+        return subprogram;
+    }
+
+    static llvm::DebugLoc get_location(Values::Function *function, antlr4::Token *token)
+    {
+        auto subprogram = function->get_ref()->getSubprogram();
+
+        if (subprogram == nullptr)
+        {
+            return llvm::DebugLoc();
+        }
+
+        return llvm::DILocation::get(subprogram->getContext(), token->getLine(), token->getCharPositionInLine() + 1, subprogram);
+    }
+
+    /**
+     * Describe a local variable (or an argument when `arg` isn't 0) stored at `address`
+     */
+    void declare_variable(llvm::Value *address, const std::string &name, Type *type, const fs::path &path, Values::Function *function, antlr4::Token *token, llvm::IRBuilder<> &builder, const unsigned &arg = 0)
+    {
+        auto subprogram = function->get_ref()->getSubprogram();
+
+        // Indirect arguments are declared on the pointer argument itself, the callee owns (byval) or borrows the memory
+        if (subprogram == nullptr || (!llvm::isa<llvm::AllocaInst>(address) && !llvm::isa<llvm::Argument>(address)))
+        {
+            return;
+        }
+
+        auto &unit = this->get_unit(path);
+        auto di_type = this->get_type(type, unit);
+
+        if (di_type == nullptr)
+        {
+            return;
+        }
+
+        llvm::DILocalVariable *variable = nullptr;
+
+        if (arg != 0)
+        {
+            variable = unit.builder->createParameterVariable(subprogram, name, arg, unit.file, token->getLine(), di_type, this->is_optimized);
+        }
+        else
+        {
+            variable = unit.builder->createAutoVariable(subprogram, name, unit.file, token->getLine(), di_type, this->is_optimized);
+        }
+
+        unit.builder->insertDeclare(address, variable, unit.builder->createExpression(), get_location(function, token), builder.GetInsertBlock());
+    }
+
+    /**
+     * Complete the compile units, code generated outside of a described body gets a line 0 location
+     */
+    void finalize()
+    {
+        for (auto &[_, unit] : this->units)
+        {
+            unit.builder->finalize();
+        }
+
+        for (auto &function : *this->module)
+        {
+            auto subprogram = function.getSubprogram();
+
+            for (auto &block : function)
+            {
+                for (auto &instruction : block)
+                {
+                    auto location = instruction.getDebugLoc();
+
+                    if (subprogram == nullptr)
+                    {
+                        if (location)
+                        {
+                            instruction.setDebugLoc(llvm::DebugLoc());
+                        }
+                    }
+                    else if ((location && location->getScope()->getSubprogram() != subprogram) || (!location && llvm::isa<llvm::CallBase>(instruction)))
+                    {
+                        instruction.setDebugLoc(llvm::DILocation::get(function.getContext(), 0, 0, subprogram));
+                    }
+                }
+            }
+        }
+    }
+};
+} // namespace Sand
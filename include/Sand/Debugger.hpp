@@ -10,7 +10,7 @@ namespace Sand
 class Debugger
 {
 private:
-    std::unordered_map<std::string, std::chrono::time_point<std::chrono::system_clock>> timers;
+    std::unordered_map<std::string, std::chrono::time_point<std::chrono::steady_clock>> timers;
 
 public:
     std::ostream out;
@@ -20,12 +20,12 @@ public:
 
     void start_timer(const std::string &name)
     {
-        timers.insert(std::pair(name, std::chrono::system_clock::now()));
+        timers.insert(std::pair(name, std::chrono::steady_clock::now()));
     }
 
     std::chrono::duration<double> end_timer(const std::string &name)
     {
-        auto now = std::chrono::system_clock::now();
+        auto now = std::chrono::steady_clock::now();
         auto timer = timers.find(name);
         auto start = timer->second;
 
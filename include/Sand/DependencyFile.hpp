@@ -0,0 +1,198 @@
+#pragma once
+
+#include <Sand/filesystem.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Sand
+{
+/**
+ * Make-style dependency file (`-MD`/`-MF`) listing the sources an output was built from.
+ *
+ * The hash of the build options is kept in a `<depfile>.options` file listed as a dependency,
+ * it is only rewritten when the options change so build systems rebuild on new options.
+ */
+class DependencyFile
+{
+private:
+    static std::string escape(const std::string &path)
+    {
+        std::string str;
+
+        for (const auto &c : path)
+        {
+            if (c == ' ' || c == '#' || c == '\\')
+            {
+                str += '\\';
+            }
+            else if (c == '$')
+            {
+                str += '$';
+            }
+
+            str += c;
+        }
+
+        return str;
+    }
+
+    static std::vector<std::string> parse(const std::string &content)
+    {
+        std::vector<std::string> paths;
+        std::string path;
+
+        auto flush = [&]() {
+            if (!path.empty())
+            {
+                paths.push_back(path);
+                path.clear();
+            }
+        };
+
+        for (size_t i = 0; i < content.size(); i++)
+        {
+            auto c = content[i];
+
+            if (c == '\\' && i + 1 < content.size())
+            {
+                auto next = content[i + 1];
+
+                if (next == '\n' || next == '\r')
+                {
+                    flush();
+                }
+                else
+                {
+                    path += next;
+                }
+
+                i++;
+            }
+            else if (c == '$' && i + 1 < content.size() && content[i + 1] == '$')
+            {
+                path += '$';
+                i++;
+            }
+            else if (c == ' ' || c == '\t' || c == '\n' || c == '\r')
+            {
+                flush();
+            }
+            else
+            {
+                path += c;
+            }
+        }
+
+        flush();
+
+        return paths;
+    }
+
+    static std::string read(const fs::path &path)
+    {
+        std::ifstream stream(path);
+        std::stringstream buffer;
+        buffer << stream.rdbuf();
+
+        return buffer.str();
+    }
+
+public:
+    static fs::path options_file(const fs::path &depfile)
+    {
+        return depfile.u8string() + ".options";
+    }
+
+    static bool write(const fs::path &depfile, const fs::path &target, const std::vector<fs::path> &dependencies, const std::string &options_hash)
+    {
+        auto options_path = options_file(depfile);
+
+        if (!fs::exists(options_path) || read(options_path) != options_hash)
+        {
+            std::ofstream options_stream(options_path);
+            options_stream << options_hash;
+        }
+
+        std::ofstream stream(depfile);
+
+        if (!stream)
+        {
+            return false;
+        }
+
+        // The target is written first, so it is also the first entry read back
+        stream << escape(target.u8string()) << ":";
+
+        for (const auto &dependency : dependencies)
+        {
+            stream << " \\\n  " << escape(dependency.u8string());
+        }
+
+        stream << " \\\n  " << escape(fs::absolute(options_path).u8string()) << "\n";
+
+        return true;
+    }
+
+    /**
+     * Files recorded in `depfile`, without its target
+     */
+    static std::vector<fs::path> read_dependencies(const fs::path &depfile)
+    {
+        auto paths = parse(read(depfile));
+
+        if (paths.empty())
+        {
+            return {};
+        }
+
+        return std::vector<fs::path>(paths.begin() + 1, paths.end());
+    }
+
+    /**
+     * Whether `target` is newer than every dependency recorded in `depfile` and was built with the same options
+     */
+    static bool is_up_to_date(const fs::path &depfile, const fs::path &target, const std::string &options_hash)
+    {
+        std::error_code error;
+
+        if (!fs::exists(depfile, error) || !fs::exists(target, error))
+        {
+            return false;
+        }
+
+        if (read(options_file(depfile)) != options_hash)
+        {
+            return false;
+        }
+
+        auto paths = parse(read(depfile));
+
+        if (paths.empty() || paths[0].back() != ':')
+        {
+            return false;
+        }
+
+        auto target_time = fs::last_write_time(target, error);
+
+        if (error)
+        {
+            return false;
+        }
+
+        for (auto it = paths.begin() + 1; it != paths.end(); it++)
+        {
+            auto dependency_time = fs::last_write_time(*it, error);
+
+            if (error || dependency_time > target_time)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+};
+} // namespace Sand
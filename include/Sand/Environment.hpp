@@ -46,12 +46,14 @@ public:
                 const std::string &target_os_,
                 const std::string &target_arch_,
                 const std::string &target_cpu_,
-                const std::string &target_features_) : builder(this->llvm_context),
-                                                       module(std::make_unique<llvm::Module>(name, this->llvm_context)),
-                                                       target_os(target_os_),
-                                                       target_arch(target_arch_),
-                                                       target_cpu(target_cpu_),
-                                                       target_features(target_features_)
+                const std::string &target_features_,
+                llvm::TargetMachine *target_machine_ = nullptr) : builder(this->llvm_context),
+                                                                  module(std::make_unique<llvm::Module>(name, this->llvm_context)),
+                                                                  target_machine(target_machine_),
+                                                                  target_os(target_os_),
+                                                                  target_arch(target_arch_),
+                                                                  target_cpu(target_cpu_),
+                                                                  target_features(target_features_)
     {
         auto vendor = "";
 
@@ -70,6 +72,13 @@ public:
 
         this->module->setTargetTriple(this->target_arch + "-" + vendor + "-" + this->target_os);
 
+        // Target machine of a previous compilation for the same target (Session)
+        if (this->target_machine != nullptr)
+        {
+            this->module->setDataLayout(this->target_machine->createDataLayout());
+            return;
+        }
+
         std::string error;
         std::string target_triple = this->module->getTargetTriple();
         const llvm::Target *target = llvm::TargetRegistry::lookupTarget(target_triple, error);
@@ -83,6 +92,13 @@ public:
         std::string features = target_features_;
 
         llvm::TargetOptions target_options;
+
+        // Every function in its own section, so the linker can order them
+        target_options.FunctionSections = true;
+
+        // Global constructors and destructors go to .init_array and .fini_array, the std _start runs them
+        target_options.UseInitArray = true;
+
         llvm::Optional<llvm::Reloc::Model> rm = llvm::Optional<llvm::Reloc::Model>();
         this->target_machine = target->createTargetMachine(target_triple, cpu, features, target_options, rm);
 
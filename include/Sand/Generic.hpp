@@ -35,8 +35,15 @@ public:
         return dynamic_cast<SandParser::TypeContext *>(default_value_context);
     }
 
-    Generic(const std::string &name_, const std::shared_ptr<Scope> &scope_, Type *type_, SandParser::ExpressionContext *default_value_context_ = nullptr) : name(name_), scope(scope_), is_expression(false), type(type_), default_value_context(default_value_context_) {}
-    Generic(const std::string &name_, const std::shared_ptr<Scope> &scope_, SandParser::TypeContext *default_value_context_ = nullptr) : name(name_), scope(scope_), is_type(true), default_value_context(default_value_context_) {}
+    Generic(const std::string &name_, const std::shared_ptr<Scope> &scope_, Type *type_, SandParser::ExpressionContext *default_value_context_ = nullptr) : name(name_), scope(scope_), is_expression(false), type(type_), default_value_context(default_value_context_)
+    {
+        Stats::construct(ObjectKind::Generic);
+    }
+
+    Generic(const std::string &name_, const std::shared_ptr<Scope> &scope_, SandParser::TypeContext *default_value_context_ = nullptr) : name(name_), scope(scope_), is_type(true), default_value_context(default_value_context_)
+    {
+        Stats::construct(ObjectKind::Generic);
+    }
 };
 
 class VariadicGeneric : public Generic
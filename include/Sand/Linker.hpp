@@ -66,7 +66,8 @@ public:
                      const std::string &output_file,
                      const std::string &mode,
                      const bool &disable_internal,
-                     const bool &verbose)
+                     const bool &verbose,
+                     const std::string &symbol_ordering_file = "")
     {
         std::vector<const char *> raw_args = {"lld"};
 
@@ -161,6 +162,15 @@ public:
             raw_args.push_back("-o");
             raw_args.push_back(output_file.c_str());
 
+            if (mode == "elf" && !symbol_ordering_file.empty())
+            {
+                // Hottest functions first, .text.hot and .text.unlikely are kept apart
+                raw_args.push_back(copy_str("--symbol-ordering-file=" + symbol_ordering_file));
+                raw_args.push_back("--no-warn-symbol-ordering");
+                raw_args.push_back("-z");
+                raw_args.push_back("keep-text-section-prefix");
+            }
+
             for (auto &arg : vectorized_args)
             {
                 raw_args.push_back(arg.c_str());
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <Sand/Stats.hpp>
+
 #include <string>
 
 namespace Sand
@@ -9,7 +11,10 @@ class Name
 public:
     std::string name;
 
-    Name(const std::string &name_) : name(name_) {}
+    Name(const std::string &name_) : name(name_)
+    {
+        Stats::construct(ObjectKind::Name);
+    }
 
     virtual ~Name() = default;
 };
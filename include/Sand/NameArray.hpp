@@ -1,6 +1,7 @@
 #pragma once
 
 #include <Sand/Name.hpp>
+#include <Sand/SemanticStats.hpp>
 #include <Sand/Type.hpp>
 #include <Sand/Values/Function.hpp>
 #include <Sand/Values/Variable.hpp>
@@ -97,6 +98,10 @@ public:
         size_t score = Type::NOT_COMPATIBLE;
         Name *best = nullptr;
 
+        // Overload resolution statistics, named after the first candidate
+        std::string candidate_name;
+        size_t candidates = 0;
+
         for (auto it = this->names.rbegin(); it != this->names.rend(); it++)
         {
             auto name = *it;
@@ -114,6 +119,11 @@ public:
                 {
                     auto compatibility = type->compare_args(args);
 
+                    if (SemanticStats::enabled && candidates++ == 0)
+                    {
+                        candidate_name = value->name;
+                    }
+
                     if (return_type)
                     {
                         if (type->return_type->is_reference && !return_type->is_reference)
@@ -135,7 +145,8 @@ public:
 
                     if (compatibility == 0)
                     {
-                        return value;
+                        best = value;
+                        break;
                     }
                     else if (compatibility < score)
                     {
@@ -149,6 +160,11 @@ public:
             // }
         }
 
+        if (candidates > 0)
+        {
+            SemanticStats::add(SemanticStats::overloads, candidate_name, candidates);
+        }
+
         return best;
     }
 
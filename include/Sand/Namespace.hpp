@@ -12,6 +12,9 @@ class Namespace : public Name
 public:
     std::shared_ptr<Scope> scope = nullptr;
 
-    Namespace(const std::string &name, std::shared_ptr<Scope> &scope_) : Name(name), scope(scope_) {}
+    Namespace(const std::string &name, std::shared_ptr<Scope> &scope_) : Name(name), scope(scope_)
+    {
+        Stats::construct(ObjectKind::Namespace, ObjectKind::Name);
+    }
 };
 } // namespace Sand
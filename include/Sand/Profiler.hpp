@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#if defined(__linux__) && defined(__x86_64__)
+    #define SAND_HAS_PROFILER
+#endif
+
+namespace Sand
+{
+struct ProfileResult
+{
+    bool success = false;
+    std::string errors;
+
+    uint64_t samples = 0;
+    uint64_t dropped = 0;
+
+    // Distinct stacks once symbolized, inlined calls included
+    uint64_t stacks = 0;
+};
+
+/**
+ * Turns the stacks sampled by the std runtime (std/sampler.sn) into collapsed stacks:
+ * one line per stack, its frames from the root separated by `;`, followed by its number of samples.
+ * That is the input of flamegraph.pl, speedscope and inferno.
+ */
+class Profiler
+{
+public:
+    static ProfileResult collapse(const std::string &samples_file, const std::string &executable, const std::string &output_file);
+};
+} // namespace Sand
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+
+#include <chrono>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace Sand
+{
+class Visitor;
+
+struct ReplResult
+{
+    bool success = false;
+    std::string value;
+    std::string errors;
+
+    // Time spent running the compiled input
+    std::chrono::duration<double> elapsed = std::chrono::duration<double>::zero();
+};
+
+/**
+ * Interactive session on the host: the scopes of the visitor are kept between inputs,
+ * every input is compiled to its own object and added to an ORC JIT.
+ * Symbols of the previous inputs are only declared and resolved to their compiled code.
+ */
+class Repl
+{
+private:
+    std::unique_ptr<Visitor> visitor;
+    std::unique_ptr<llvm::orc::LLJIT> jit;
+
+    std::set<std::string> emitted;
+    size_t inputs = 0;
+
+    std::unique_ptr<llvm::Module> extract_new_definitions();
+
+public:
+    Repl(const std::string &target_os,
+         const std::string &target_arch,
+         const std::string &target_cpu = "generic",
+         const std::string &target_features = "",
+         const std::string &builtins_path = "",
+         const std::vector<std::string> &include_paths = {});
+
+    ~Repl();
+
+    /**
+     * Elaborate, compile and run an input, its declarations stay available to the next ones
+     */
+    ReplResult evaluate(const std::string &input);
+};
+} // namespace Sand
@@ -4,6 +4,7 @@
 #include <Sand/Loop.hpp>
 #include <Sand/Name.hpp>
 #include <Sand/NameArray.hpp>
+#include <Sand/SemanticStats.hpp>
 #include <Sand/Type.hpp>
 #include <Sand/Value.hpp>
 #include <Sand/Values/Function.hpp>
@@ -24,8 +25,18 @@ public:
 
     std::multimap<std::string, Name *> names;
 
-    Scope(Environment &env_) : env(env_) {}
-    Scope(std::shared_ptr<Scope> &parent_, Values::Function *function_ = nullptr) : env(parent_->env), parent(parent_), function(function_) {}
+    // Values that may need a destructor call on scope exit, in declaration order
+    std::vector<Value *> destructibles;
+
+    Scope(Environment &env_) : env(env_)
+    {
+        Stats::construct(ObjectKind::Scope);
+    }
+
+    Scope(std::shared_ptr<Scope> &parent_, Values::Function *function_ = nullptr) : env(parent_->env), parent(parent_), function(function_)
+    {
+        Stats::construct(ObjectKind::Scope);
+    }
 
     static std::shared_ptr<Scope> from(Environment &env, const std::vector<std::shared_ptr<Scope>> &scopes)
     {
@@ -132,10 +143,33 @@ public:
     void add_name(const std::string &name, Name *value, const bool &must_be_unique = false)
     {
         this->names.insert(std::make_pair(name, value));
+
+        if (auto variable = dynamic_cast<Value *>(value))
+        {
+            if (variable->type != nullptr && Type::get_origin(variable->type)->is_struct())
+            {
+                this->destructibles.push_back(variable);
+            }
+        }
     }
 
     NameArray *get_names(const std::string &name)
     {
+        size_t depth = 0;
+        auto names = this->find_names(name, depth);
+
+        SemanticStats::add(SemanticStats::lookups, name, depth);
+
+        return names;
+    }
+
+    /**
+     * Names in this scope and its parents, `depth` is incremented for each scope searched
+     */
+    NameArray *find_names(const std::string &name, size_t &depth)
+    {
+        depth++;
+
         if (auto type = this->get_primary_type(name))
         {
             return new NameArray({type});
@@ -152,7 +186,7 @@ public:
 
         if (this->parent != nullptr)
         {
-            auto parent_names = this->parent->get_names(name);
+            auto parent_names = this->parent->find_names(name, depth);
             array->merge(parent_names);
         }
 
@@ -33,6 +33,11 @@ public:
         this->scopes.push(scope);
     }
 
+    size_t size() const
+    {
+        return this->scopes.size();
+    }
+
     std::shared_ptr<Scope> &top()
     {
         return this->scopes.top();
@@ -70,29 +75,26 @@ public:
         this->scopes.pop();
     }
 
-    void call_destructors(std::shared_ptr<Scope> &scope)
+    void call_destructors(std::shared_ptr<Scope> &scope, Value *moved = nullptr)
     {
-        for (auto &[_, name] : scope->names)
+        // Variables are destroyed in the reverse order of their declaration
+        for (auto it = scope->destructibles.rbegin(); it != scope->destructibles.rend(); it++)
         {
-            if (auto variable = dynamic_cast<Value *>(name))
+            auto variable = *it;
+
+            if (variable == moved)
             {
-                if (auto class_type = dynamic_cast<Types::ClassType *>(Type::get_origin(variable->type)))
+                continue;
+            }
+
+            if (auto class_type = dynamic_cast<Types::ClassType *>(Type::get_origin(variable->type)))
+            {
+                for (auto &destructor : class_type->get_destructors())
                 {
-                    if (class_type->is_pointer() || class_type->is_array())
-                    {
-                        continue;
-                    }
-
-                    auto destructors = class_type->get_names("@destructor", variable, scope->builder(), scope->module());
-
-                    for (auto &name : destructors->names)
-                    {
-                        if (auto destructor = dynamic_cast<Values::Function *>(name))
-                        {
-                            destructor->calling_variable = variable;
-                            destructor->call(scope->builder(), scope->module());
-                        }
-                    }
+                    destructor->calling_variable = variable;
+                    destructor->call(scope->builder(), scope->module());
+
+                    SemanticStats::add(SemanticStats::destructors, class_type->name);
                 }
             }
         }
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace llvm
+{
+class Module;
+} // namespace llvm
+
+namespace Sand
+{
+/**
+ * Occurrences of an event for one key (a template, a name, a type conversion...) and their total cost
+ */
+struct SemanticCounter
+{
+    uint64_t count = 0;
+    uint64_t cost = 0;
+};
+
+using SemanticCounters = std::map<std::string, SemanticCounter>;
+
+/**
+ * Counters of the Visitor (--semantic-stats), to find the code making compilation slow or the output big
+ */
+class SemanticStats
+{
+public:
+    static inline bool enabled = false;
+
+    // Cost: LLVM instructions of the functions generated by the instantiation, without the nested ones
+    static inline SemanticCounters instantiations;
+
+    // Cost: scopes searched by Scope::get_names
+    static inline SemanticCounters lookups;
+
+    // Cost: candidates scored by the overload resolution
+    static inline SemanticCounters overloads;
+
+    // Conversions emitted by Value::cast, from one type to another
+    static inline SemanticCounters casts;
+
+    // Cost: bytes of the temporaries receiving the result of a sret function
+    static inline SemanticCounters sret_temporaries;
+
+    // Destructor calls emitted on scope exit, per class
+    static inline SemanticCounters destructors;
+
+    static void add(SemanticCounters &counters, const std::string &key, const uint64_t &cost = 1)
+    {
+        if (!enabled)
+        {
+            return;
+        }
+
+        auto &counter = counters[key];
+        counter.count++;
+        counter.cost += cost;
+    }
+
+    /**
+     * Each section ranked by cost, limited to its `limit` most expensive keys
+     */
+    static std::string report(const size_t &limit = 20);
+
+    /**
+     * Attributes the functions added to the module while it exists to the instantiation of a template.
+     * Uncounted ones add the cost of methods generated after the instantiation itself (nested classes) to its template
+     */
+    class Instantiation
+    {
+    private:
+        bool active = false;
+        std::string name;
+        const llvm::Module *module = nullptr;
+        size_t functions = 0;
+        bool counted = true;
+
+    public:
+        Instantiation(const std::string &name_, const llvm::Module *module_, const bool &counted_ = true);
+
+        ~Instantiation();
+
+        Instantiation(const Instantiation &) = delete;
+        Instantiation &operator=(const Instantiation &) = delete;
+    };
+};
+} // namespace Sand
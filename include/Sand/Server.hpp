@@ -0,0 +1,455 @@
+#pragma once
+
+#include <Sand/filesystem.hpp>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if !defined(WIN32) && !defined(_WIN32) && !defined(__WIN32__) && !defined(__NT__)
+    #define SAND_HAS_SERVER
+
+    #include <signal.h>
+    #include <sys/socket.h>
+    #include <sys/stat.h>
+    #include <sys/un.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
+namespace Sand
+{
+#ifdef SAND_HAS_SERVER
+/**
+ * Compile server listening on a local Unix socket.
+ *
+ * A request is the working directory of the client followed by its build arguments.
+ * The response is a sequence of records, each a kind and a length-prefixed payload:
+ * the output of the build in chunks, then its exit status.
+ */
+class Server
+{
+private:
+    enum Record : uint8_t
+    {
+        Output,
+        Status
+    };
+
+    std::string socket_path;
+    int socket_fd = -1;
+
+    static bool write_all(int fd, const void *data, size_t size)
+    {
+        auto bytes = static_cast<const char *>(data);
+
+        while (size > 0)
+        {
+            auto written = ::write(fd, bytes, size);
+
+            if (written <= 0)
+            {
+                return false;
+            }
+
+            bytes += written;
+            size -= written;
+        }
+
+        return true;
+    }
+
+    static bool read_all(int fd, void *data, size_t size)
+    {
+        auto bytes = static_cast<char *>(data);
+
+        while (size > 0)
+        {
+            auto count = ::read(fd, bytes, size);
+
+            if (count <= 0)
+            {
+                return false;
+            }
+
+            bytes += count;
+            size -= count;
+        }
+
+        return true;
+    }
+
+    static bool write_strings(int fd, const std::vector<std::string> &strings)
+    {
+        uint32_t count = strings.size();
+
+        if (!write_all(fd, &count, sizeof(count)))
+        {
+            return false;
+        }
+
+        for (const auto &string : strings)
+        {
+            uint32_t size = string.size();
+
+            if (!write_all(fd, &size, sizeof(size)) || !write_all(fd, string.data(), size))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    static bool write_record(int fd, const Record &kind, const std::string &payload)
+    {
+        uint8_t record = kind;
+        uint32_t size = payload.size();
+
+        return write_all(fd, &record, sizeof(record)) && write_all(fd, &size, sizeof(size)) && write_all(fd, payload.data(), size);
+    }
+
+    static bool read_record(int fd, Record &kind, std::string &payload)
+    {
+        uint8_t record;
+        uint32_t size;
+
+        if (!read_all(fd, &record, sizeof(record)) || !read_all(fd, &size, sizeof(size)))
+        {
+            return false;
+        }
+
+        kind = static_cast<Record>(record);
+        payload.assign(size, '\0');
+
+        return read_all(fd, payload.data(), size);
+    }
+
+    static bool read_strings(int fd, std::vector<std::string> &strings)
+    {
+        uint32_t count;
+
+        if (!read_all(fd, &count, sizeof(count)))
+        {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            uint32_t size;
+
+            if (!read_all(fd, &size, sizeof(size)))
+            {
+                return false;
+            }
+
+            std::string string(size, '\0');
+
+            if (!read_all(fd, string.data(), size))
+            {
+                return false;
+            }
+
+            strings.push_back(string);
+        }
+
+        return true;
+    }
+
+    static bool make_address(const std::string &path, sockaddr_un &address)
+    {
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+
+        if (path.size() >= sizeof(address.sun_path))
+        {
+            return false;
+        }
+
+        std::strcpy(address.sun_path, path.c_str());
+
+        return true;
+    }
+
+public:
+    Server(const std::string &socket_path_) : socket_path(socket_path_) {}
+
+    ~Server()
+    {
+        if (this->socket_fd != -1)
+        {
+            ::close(this->socket_fd);
+            ::unlink(this->socket_path.c_str());
+        }
+    }
+
+    /**
+     * In the runtime directory of the user, or in a private directory of the temporary one
+     */
+    static std::string default_socket_path()
+    {
+        if (auto runtime_directory = std::getenv("XDG_RUNTIME_DIR"))
+        {
+            if (*runtime_directory != '\0')
+            {
+                return (fs::path(runtime_directory) / "sand-server.sock").u8string();
+            }
+        }
+
+        return (fs::temp_directory_path() / ("sand-" + std::to_string(::getuid())) / "server.sock").u8string();
+    }
+
+    /**
+     * Create the directory of the socket, only its owner may replace the socket in it
+     */
+    bool make_directory()
+    {
+        auto directory = fs::path(this->socket_path).parent_path();
+
+        if (directory.empty())
+        {
+            directory = ".";
+        }
+
+        if (::mkdir(directory.c_str(), 0700) == -1 && errno != EEXIST)
+        {
+            return false;
+        }
+
+        struct stat status;
+
+        if (::lstat(directory.c_str(), &status) == -1 || !S_ISDIR(status.st_mode))
+        {
+            return false;
+        }
+
+        // Shared directories like /tmp are owned by root and sticky
+        auto is_owned = status.st_uid == ::getuid() || status.st_uid == 0;
+        auto is_writable_by_others = (status.st_mode & (S_IWGRP | S_IWOTH)) != 0 && (status.st_mode & S_ISVTX) == 0;
+
+        return is_owned && !is_writable_by_others;
+    }
+
+    bool listen()
+    {
+        sockaddr_un address;
+
+        if (!make_address(this->socket_path, address) || !this->make_directory())
+        {
+            return false;
+        }
+
+        this->socket_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+        if (this->socket_fd == -1)
+        {
+            return false;
+        }
+
+        ::unlink(this->socket_path.c_str());
+
+        // Jobs run with the permissions of the server, only its user may connect
+        auto mask = ::umask(0077);
+        auto bound = ::bind(this->socket_fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != -1;
+        ::umask(mask);
+
+        if (!bound || ::chmod(this->socket_path.c_str(), 0600) == -1 || ::listen(this->socket_fd, SOMAXCONN) == -1)
+        {
+            return false;
+        }
+
+        // Jobs run in forked children that are never waited for
+        ::signal(SIGCHLD, SIG_IGN);
+
+        // Writing to a client gone fails instead of killing the server
+        ::signal(SIGPIPE, SIG_IGN);
+
+        return true;
+    }
+
+    /**
+     * Wait for the next job, return the client connection or -1
+     */
+    int accept(std::string &directory, std::vector<std::string> &args)
+    {
+        while (true)
+        {
+            auto client_fd = ::accept(this->socket_fd, nullptr, nullptr);
+
+            if (client_fd == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+
+                return -1;
+            }
+
+            std::vector<std::string> request;
+
+            if (!read_strings(client_fd, request) || request.empty())
+            {
+                ::close(client_fd);
+                continue;
+            }
+
+            directory = request[0];
+            args.assign(request.begin() + 1, request.end());
+
+            return client_fd;
+        }
+    }
+
+    /**
+     * Send output to the client, false once it has disconnected
+     */
+    static bool send(int client_fd, const std::string &output)
+    {
+        return write_record(client_fd, Record::Output, output);
+    }
+
+    /**
+     * Run `job` in a child process, send what it writes to its standard output and error, return its exit status
+     */
+    static int run(int client_fd, const std::function<int()> &job)
+    {
+        int pipe_fds[2];
+
+        if (::pipe(pipe_fds) == -1)
+        {
+            return 1;
+        }
+
+        // The job is waited for its exit status
+        ::signal(SIGCHLD, SIG_DFL);
+
+        auto pid = ::fork();
+
+        if (pid == -1)
+        {
+            ::close(pipe_fds[0]);
+            ::close(pipe_fds[1]);
+
+            return 1;
+        }
+
+        if (pid == 0)
+        {
+            ::close(pipe_fds[0]);
+            ::dup2(pipe_fds[1], STDOUT_FILENO);
+            ::dup2(pipe_fds[1], STDERR_FILENO);
+            ::close(pipe_fds[1]);
+
+            _exit(job());
+        }
+
+        ::close(pipe_fds[1]);
+
+        char buffer[4096];
+        ssize_t count;
+
+        while ((count = ::read(pipe_fds[0], buffer, sizeof(buffer))) != 0)
+        {
+            if (count == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+
+                break;
+            }
+
+            // The job keeps running when the client is gone, its output is dropped
+            send(client_fd, std::string(buffer, count));
+        }
+
+        ::close(pipe_fds[0]);
+
+        int status;
+
+        while (::waitpid(pid, &status, 0) == -1)
+        {
+            if (errno != EINTR)
+            {
+                return 1;
+            }
+        }
+
+        return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+    }
+
+    /**
+     * Send the exit status of a job and close the connection
+     */
+    static void finish(int client_fd, const int &status)
+    {
+        // A client gone before the end of its job is not an error of the server
+        write_record(client_fd, Record::Status, std::string(1, static_cast<char>(status)));
+
+        ::close(client_fd);
+    }
+
+    /**
+     * Send a job to a running server, forward its output and return its exit status
+     */
+    static int request(const std::string &socket_path, const std::vector<std::string> &args, std::ostream &out)
+    {
+        sockaddr_un address;
+
+        if (!make_address(socket_path, address))
+        {
+            out << "Invalid server socket path: '" << socket_path << "'." << std::endl;
+            return 1;
+        }
+
+        auto fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+        if (fd == -1 || ::connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == -1)
+        {
+            out << "Could not connect to the compile server on '" << socket_path << "', start it with `sand server`." << std::endl;
+            return 1;
+        }
+
+        std::vector<std::string> request = {fs::current_path().u8string()};
+        request.insert(request.end(), args.begin(), args.end());
+
+        if (!write_strings(fd, request))
+        {
+            ::close(fd);
+
+            out << "Could not send the job to the compile server." << std::endl;
+            return 1;
+        }
+
+        Record kind;
+        std::string payload;
+        int status = 1;
+
+        while (read_record(fd, kind, payload))
+        {
+            if (kind == Record::Output)
+            {
+                out << payload;
+            }
+            else if (kind == Record::Status && payload.size() == 1)
+            {
+                status = static_cast<unsigned char>(payload[0]);
+                break;
+            }
+        }
+
+        out.flush();
+        ::close(fd);
+
+        return status;
+    }
+};
+#endif
+} // namespace Sand
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/MemoryBuffer.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace llvm
+{
+class TargetMachine;
+} // namespace llvm
+
+namespace Sand
+{
+class ParseCache;
+class Visitor;
+
+struct CompilationResult
+{
+    bool success = false;
+    std::string errors;
+
+    std::vector<std::unique_ptr<llvm::MemoryBuffer>> objects;
+};
+
+/**
+ * Entry point of libsand: compiles many programs for a same target, in-process.
+ * LLVM targets are initialized once, every compilation gets its own module.
+ * The target machine and the parse trees of the builtins and unchanged imports are kept between compilations.
+ *
+ * A Session is not thread-safe, and compilations of different Sessions must not run concurrently either:
+ * the Stats and SemanticStats counters are global to the process.
+ */
+class Session
+{
+public:
+    std::string target_os;
+    std::string target_arch;
+    std::string target_cpu;
+    std::string target_features;
+
+    std::string builtins_path;
+    std::vector<std::string> include_paths;
+
+    llvm::PassBuilder::OptimizationLevel optimization_level = llvm::PassBuilder::OptimizationLevel::O0;
+
+    Session(const std::string &target_os_,
+            const std::string &target_arch_,
+            const std::string &target_cpu_ = "generic",
+            const std::string &target_features_ = "",
+            const std::string &builtins_path_ = "",
+            const std::vector<std::string> &include_paths_ = {});
+
+    ~Session();
+
+    static void initialize_targets();
+
+    /**
+     * Compile source code held in memory, `name` is used to resolve its relative imports
+     */
+    CompilationResult compile_source(const std::string &source, const std::string &name = "input.sn");
+
+    CompilationResult compile_file(const std::string &path);
+
+private:
+    // Created by the first compilation, for the target of the Session
+    llvm::TargetMachine *target_machine = nullptr;
+
+    std::unique_ptr<ParseCache> parse_cache;
+
+    CompilationResult compile(const std::function<void(Visitor &)> &load);
+};
+} // namespace Sand
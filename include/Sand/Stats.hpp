@@ -0,0 +1,134 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace llvm
+{
+class Module;
+class PassInstrumentationCallbacks;
+} // namespace llvm
+
+namespace Sand
+{
+enum class ObjectKind
+{
+    Name,
+    Type,
+    GenericType,
+    Value,
+    Scope,
+    Generic,
+    Namespace,
+    Count
+};
+
+/**
+ * Resources of a compiler phase, including its nested phases.
+ * Phases of the same name (the LLVM passes run on each function) are accumulated in one entry.
+ */
+struct PhaseStats
+{
+    std::string name;
+    unsigned depth = 0;
+    uint64_t runs = 0;
+
+    double seconds = 0;
+
+    // Bytes, the peak RSS is the highest one of the process during the phase
+    uint64_t peak_rss = 0;
+    uint64_t allocated = 0;
+    uint64_t allocations = 0;
+
+    uint64_t objects[static_cast<size_t>(ObjectKind::Count)] = {};
+
+    // The module at the end of the phase
+    bool has_module = false;
+    uint64_t functions = 0;
+    uint64_t instructions = 0;
+    uint64_t globals = 0;
+};
+
+/**
+ * Memory and allocation accounting of the compiler phases (--stats).
+ * Allocations are counted by the operator new of the sand executable, front-end objects by their constructors.
+ */
+class Stats
+{
+public:
+    static inline bool enabled = false;
+
+    static inline std::atomic<uint64_t> allocated{0};
+    static inline std::atomic<uint64_t> allocations{0};
+
+    static inline uint64_t objects[static_cast<size_t>(ObjectKind::Count)] = {};
+
+    static void allocate(const std::size_t &size)
+    {
+        allocated.fetch_add(size, std::memory_order_relaxed);
+        allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void construct(const ObjectKind &kind)
+    {
+        objects[static_cast<size_t>(kind)]++;
+    }
+
+    /**
+     * Counts a subclass object, the base constructor already counted it as a base
+     */
+    static void construct(const ObjectKind &kind, const ObjectKind &base)
+    {
+        objects[static_cast<size_t>(base)]--;
+        objects[static_cast<size_t>(kind)]++;
+    }
+
+    static void begin(const std::string &name);
+
+    static void end();
+
+    /**
+     * Module whose functions, instructions and globals are counted at the end of each phase
+     */
+    static void set_module(const llvm::Module *module);
+
+    /**
+     * Every top-level pass of the new pass manager is a phase
+     */
+    static void register_callbacks(llvm::PassInstrumentationCallbacks &callbacks);
+
+    static const std::vector<PhaseStats> &get_phases();
+
+    static std::string report();
+
+    static bool write_json(const std::string &file, std::string &errors);
+
+    class Phase
+    {
+    private:
+        bool active = false;
+
+    public:
+        Phase(const std::string &name) : active(Stats::enabled)
+        {
+            if (this->active)
+            {
+                Stats::begin(name);
+            }
+        }
+
+        ~Phase()
+        {
+            if (this->active)
+            {
+                Stats::end();
+            }
+        }
+
+        Phase(const Phase &) = delete;
+        Phase &operator=(const Phase &) = delete;
+    };
+};
+} // namespace Sand
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <llvm/Target/TargetMachine.h>
+
+#include <string>
+#include <vector>
+
+namespace Sand
+{
+/**
+ * Static throughput analysis (llvm-mca) of the machine code of selected functions, on the CPU of the target machine.
+ * Each basic block is simulated on its own, as the body of a loop running `iterations` times.
+ */
+class ThroughputAnalyzer
+{
+private:
+    llvm::TargetMachine *target_machine = nullptr;
+    unsigned iterations = 100;
+
+public:
+    ThroughputAnalyzer(llvm::TargetMachine *target_machine_, const unsigned &iterations_ = 100) : target_machine(target_machine_), iterations(iterations_) {}
+
+    /**
+     * Report of the IPC, resource pressure and bottlenecks of every block of `functions`, found in `assembly`
+     */
+    std::string analyze(const std::string &assembly, const std::vector<std::string> &functions);
+};
+} // namespace Sand
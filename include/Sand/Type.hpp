@@ -40,9 +40,13 @@ public:
                                               ref(ref_),
                                               base(base_)
     {
+        Stats::construct(ObjectKind::Type, ObjectKind::Name);
     }
 
-    Type(const std::string &name, const bool &is_variadic_) : Name(name), is_variadic(is_variadic_) {}
+    Type(const std::string &name, const bool &is_variadic_) : Name(name), is_variadic(is_variadic_)
+    {
+        Stats::construct(ObjectKind::Type, ObjectKind::Name);
+    }
 
     virtual llvm::Type *get_ref() const
     {
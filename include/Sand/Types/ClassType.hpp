@@ -45,6 +45,12 @@ public:
     std::vector<SandParser::ClassMethodContext *> pending_methods;
     bool generated = false;
 
+    // Set once every pending method is declared, bodies generated before can still see an incomplete scope
+    bool methods_declared = false;
+
+    std::vector<Values::Function *> destructors;
+    bool has_destructors_cache = false;
+
     ClassType(const std::string &name,
               llvm::StructType *ref,
               std::shared_ptr<Scope> static_scope_,
@@ -82,6 +88,46 @@ public:
         return names;
     }
 
+    /**
+     * Destructors of the class followed by the ones of its parents
+     */
+    std::vector<Values::Function *> get_destructors()
+    {
+        if (this->has_destructors_cache)
+        {
+            return this->destructors;
+        }
+
+        std::vector<Values::Function *> destructors;
+
+        for (auto &name : this->scope->get_names("@destructor")->names)
+        {
+            if (auto destructor = dynamic_cast<Values::Function *>(name))
+            {
+                destructors.push_back(destructor);
+            }
+        }
+
+        auto parents_cached = true;
+
+        for (auto &parent : this->parents)
+        {
+            auto parent_destructors = parent->get_destructors();
+            destructors.insert(destructors.end(), parent_destructors.begin(), parent_destructors.end());
+
+            parents_cached = parents_cached && parent->has_destructors_cache;
+        }
+
+        // Once the methods of the class and its parents are declared, the list can't change anymore
+        if (this->methods_declared && this->pending_methods.empty() && parents_cached)
+        {
+            this->destructors = destructors;
+            this->has_destructors_cache = true;
+        }
+
+        return destructors;
+    }
+
     std::shared_ptr<Scope> get_static_scope()
     {
         std::vector<std::shared_ptr<Scope>> scopes;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <Sand/ABI.hpp>
 #include <Sand/Type.hpp>
 #include <Sand/Values/Constant.hpp>
 
@@ -27,6 +28,11 @@ public:
     bool is_sret = false;
     bool is_method = false;
 
+    llvm::CallingConv::ID calling_convention = llvm::CallingConv::C;
+
+    ABIInfo return_abi;
+    std::vector<ABIInfo> args_abi;
+
     std::vector<Name *> generics;
 
     FunctionType(const std::string &name,
@@ -47,36 +53,89 @@ public:
         auto return_llvm_type = return_type->get_ref();
         std::vector<llvm::Type *> argument_llvm_types;
 
-        auto return_type_size = return_type->size(module);
-
-        auto is_sret = false;
+        ABIInfo return_abi;
+        std::vector<ABIInfo> args_abi(args.size());
 
         if (auto_sret)
         {
-            is_sret = return_type->is_struct() || (return_type_size > 8);
+            std::vector<Type *> args_types;
+
+            for (const auto &arg : args)
+            {
+                args_types.push_back(arg.type);
+            }
+
+            return_abi = ABI::classify_return(return_type, module);
+            args_abi = ABI::classify_arguments(args_types, return_abi, module);
+        }
+
+        auto is_sret = return_abi.kind == ABIKind::Indirect;
 
-            if (is_sret)
+        if (is_sret)
+        {
+            if (return_type->is_pointer())
+            {
+                argument_llvm_types.push_back(return_type->get_ref());
+            }
+            else
             {
-                if (return_type->is_pointer())
-                {
-                    argument_llvm_types.push_back(return_type->get_ref());
-                }
-                else
-                {
-                    argument_llvm_types.push_back(Type::pointer(return_type)->get_ref());
-                }
-
-                return_llvm_type = Type::llvm_void(builder.getContext());
+                argument_llvm_types.push_back(Type::pointer(return_type)->get_ref());
             }
+
+            return_llvm_type = Type::llvm_void(builder.getContext());
+        }
+        else if (return_abi.kind == ABIKind::Coerced)
+        {
+            return_llvm_type = return_abi.coerced_type;
         }
 
-        for (const auto &arg : args)
+        for (size_t i = 0; i < args.size(); i++)
         {
-            argument_llvm_types.push_back(arg.type->get_ref());
+            auto &abi = args_abi[i];
+
+            if (abi.kind == ABIKind::Coerced)
+            {
+                argument_llvm_types.push_back(abi.coerced_type);
+            }
+            else if (abi.kind == ABIKind::Indirect)
+            {
+                argument_llvm_types.push_back(Type::pointer(args[i].type)->get_ref());
+            }
+            else
+            {
+                argument_llvm_types.push_back(args[i].type->get_ref());
+            }
         }
 
         auto ref = llvm::FunctionType::get(return_llvm_type, argument_llvm_types, is_variadic);
-        return new FunctionType(name, ref, return_type, args, is_variadic, is_sret, is_method);
+
+        auto type = new FunctionType(name, ref, return_type, args, is_variadic, is_sret, is_method);
+        type->return_abi = return_abi;
+        type->args_abi = args_abi;
+
+        return type;
+    }
+
+    llvm::AttributeList get_abi_attributes(llvm::LLVMContext &context) const
+    {
+        llvm::AttributeList attributes;
+        unsigned offset = 0;
+
+        if (this->is_sret)
+        {
+            attributes = attributes.addParamAttribute(context, 0, llvm::Attribute::StructRet);
+            offset = 1;
+        }
+
+        for (size_t i = 0; i < this->args_abi.size(); i++)
+        {
+            if (this->args_abi[i].kind == ABIKind::Indirect && this->args_abi[i].is_byval)
+            {
+                attributes = attributes.addParamAttribute(context, i + offset, llvm::Attribute::ByVal);
+            }
+        }
+
+        return attributes;
     }
 
     llvm::FunctionType *get_ref() const override
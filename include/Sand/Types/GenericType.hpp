@@ -18,6 +18,7 @@ public:
 
     GenericType(const std::shared_ptr<Scope> &scope_, const std::string &name, const std::vector<Generic *> &generics_) : Name(name), scope(scope_), generics(generics_)
     {
+        Stats::construct(ObjectKind::GenericType, ObjectKind::Name);
     }
 
     static void flatten_variadics(std::vector<Name *> &target)
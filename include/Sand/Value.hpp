@@ -19,9 +19,13 @@ public:
 
     Value(const std::string &name, Type *type_, llvm::Value *ref_, const bool &is_alloca_ = false) : Name(name), type(type_), ref(ref_), is_alloca(is_alloca_)
     {
+        Stats::construct(ObjectKind::Value, ObjectKind::Name);
     }
 
-    Value(const std::string &name, const bool &is_variadic_) : Name(name), is_variadic(is_variadic_) {}
+    Value(const std::string &name, const bool &is_variadic_) : Name(name), is_variadic(is_variadic_)
+    {
+        Stats::construct(ObjectKind::Value, ObjectKind::Name);
+    }
 
     virtual llvm::Value *get_ref() const
     {
@@ -62,9 +66,14 @@ public:
             auto rvalue = value->cast(i8ptr, builder, module, false);
             lvalue = lvalue->cast(i8ptr, builder, module, false);
 
+            auto &layout = module->getDataLayout();
+
+            auto lvalue_align = llvm::MaybeAlign(layout.getABITypeAlignment(Type::get_origin(lvalue->type)->get_ref()));
+            auto rvalue_align = llvm::MaybeAlign(layout.getABITypeAlignment(Type::get_origin(rvalue->type)->get_ref()));
+
             auto size = llvm::ConstantInt::get(llvm::Type::getInt64Ty(builder.getContext()), Type::get_origin(lvalue->type)->size(module));
 
-            builder.CreateMemCpy(lvalue->get_ref(), llvm::Align(1), rvalue->get_ref(), llvm::Align(1), llvm::cast<llvm::Value>(size));
+            builder.CreateMemCpy(lvalue->get_ref(), lvalue_align, rvalue->get_ref(), rvalue_align, llvm::cast<llvm::Value>(size));
         }
         else if (this->type->is_array() && value->type->is_array())
         {
@@ -183,6 +192,25 @@ public:
         return value->load_reference(builder);
     }
 
+    Value *get_address(llvm::IRBuilder<> &builder)
+    {
+        if (this->is_alloca)
+        {
+            if (this->type->is_reference)
+            {
+                auto value = this->load_reference(builder);
+                return new Value(value->name, value->type, value->get_ref(), true);
+            }
+
+            return this;
+        }
+
+        auto alloca = builder.CreateAlloca(this->type->get_ref(), nullptr, this->name + ".tmp");
+        builder.CreateStore(this->get_ref(), alloca);
+
+        return new Value(this->name, this->type, alloca, true);
+    }
+
     Value *gep(Value *index, llvm::IRBuilder<> &builder, std::unique_ptr<llvm::Module> &module)
     {
         auto index_value = index->cast(Type::i64(builder.getContext()), builder, module);
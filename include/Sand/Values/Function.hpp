@@ -17,9 +17,15 @@ public:
 
     Variable *return_value = nullptr;
 
+    bool is_tailcall = false;
+
+    // Calls in return position of a `#[tailcall]` function, marked `tail` once the body is complete
+    std::vector<llvm::CallInst *> tail_calls;
+
     Function(std::unique_ptr<llvm::Module> &module, Types::FunctionType *type, const llvm::GlobalValue::LinkageTypes &linkage = llvm::GlobalValue::LinkageTypes::LinkOnceAnyLinkage) : Value(type->name, type, nullptr)
     {
         this->ref = llvm::Function::Create(type->get_ref(), linkage, type->name, module.get());
+        this->get_ref()->setAttributes(type->get_abi_attributes(module->getContext()));
     }
 
     Types::FunctionType *get_type()
@@ -18,6 +18,12 @@ public:
         return new GlobalVariable(name, type, global);
     }
 
+    static GlobalVariable *declare(const std::string &name, std::unique_ptr<llvm::Module> &module, Type *type)
+    {
+        auto global = new llvm::GlobalVariable(*module, type->get_ref(), false, llvm::GlobalValue::LinkageTypes::ExternalLinkage, nullptr, name);
+        return new GlobalVariable(name, type, global);
+    }
+
     llvm::GlobalVariable *get_ref() const override
     {
         return llvm::cast<llvm::GlobalVariable>(this->ref);
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <Sand/filesystem.hpp>
+
+#include <map>
+#include <set>
+#include <vector>
+
+#ifdef __linux__
+    #define SAND_HAS_WATCH
+
+    #include <poll.h>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#endif
+
+namespace Sand
+{
+#ifdef SAND_HAS_WATCH
+/**
+ * Watch source files with inotify.
+ *
+ * The directories of the files are watched rather than the files themselves,
+ * editors often save by replacing the file which would drop a watch on it.
+ */
+class Watcher
+{
+private:
+    // Events following the first change are collected for this long, a save often triggers several
+    static constexpr int SETTLE_MILLISECONDS = 50;
+
+    int fd = -1;
+    std::map<int, fs::path> directories;
+    std::set<fs::path> files;
+
+    void read_events(std::set<fs::path> &changed)
+    {
+        alignas(inotify_event) char buffer[4096];
+
+        auto count = ::read(this->fd, buffer, sizeof(buffer));
+
+        for (ssize_t offset = 0; offset < count;)
+        {
+            auto event = reinterpret_cast<inotify_event *>(buffer + offset);
+            offset += sizeof(inotify_event) + event->len;
+
+            auto directory = this->directories.find(event->wd);
+
+            if (directory == this->directories.end() || event->len == 0)
+            {
+                continue;
+            }
+
+            auto path = directory->second / event->name;
+
+            if (this->files.count(path))
+            {
+                changed.insert(path);
+            }
+        }
+    }
+
+public:
+    Watcher() : fd(::inotify_init1(IN_CLOEXEC)) {}
+
+    ~Watcher()
+    {
+        if (this->fd != -1)
+        {
+            ::close(this->fd);
+        }
+    }
+
+    bool is_valid() const
+    {
+        return this->fd != -1;
+    }
+
+    void watch(const std::vector<fs::path> &paths)
+    {
+        for (const auto &path : paths)
+        {
+            if (!this->files.insert(path).second)
+            {
+                continue;
+            }
+
+            auto directory = path.parent_path();
+            auto wd = ::inotify_add_watch(this->fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+
+            if (wd != -1)
+            {
+                this->directories[wd] = directory;
+            }
+        }
+    }
+
+    /**
+     * Block until watched files change, return them
+     */
+    std::vector<fs::path> wait()
+    {
+        std::set<fs::path> changed;
+
+        while (changed.empty())
+        {
+            this->read_events(changed);
+        }
+
+        pollfd poll_fd = {this->fd, POLLIN, 0};
+
+        while (::poll(&poll_fd, 1, SETTLE_MILLISECONDS) > 0)
+        {
+            this->read_events(changed);
+        }
+
+        return std::vector<fs::path>(changed.begin(), changed.end());
+    }
+};
+#endif
+} // namespace Sand
@@ -0,0 +1,261 @@
+#include <Sand/Benchmark.hpp>
+
+#include <llvm/Support/Format.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace Sand;
+
+// "SANDBNCH"
+static constexpr uint64_t SAMPLES_MAGIC = 0x48434e42444e4153;
+static constexpr uint64_t SAMPLES_VERSION = 1;
+
+static constexpr int64_t BASELINE_VERSION = 1;
+
+static std::string format_duration(const double &nanoseconds)
+{
+    if (nanoseconds >= 1e9)
+    {
+        return llvm::formatv("{0:F2} s", nanoseconds / 1e9);
+    }
+    else if (nanoseconds >= 1e6)
+    {
+        return llvm::formatv("{0:F2} ms", nanoseconds / 1e6);
+    }
+    else if (nanoseconds >= 1e3)
+    {
+        return llvm::formatv("{0:F2} us", nanoseconds / 1e3);
+    }
+
+    return llvm::formatv("{0:F2} ns", nanoseconds);
+}
+
+BenchmarkResult Benchmarks::read(const std::string &samples_file)
+{
+    BenchmarkResult result;
+
+    auto buffer = llvm::MemoryBuffer::getFile(samples_file);
+
+    if (!buffer)
+    {
+        result.errors = "Could not read the samples of the benchmarks, " + buffer.getError().message() + ".\n";
+        return result;
+    }
+
+    auto size = (*buffer)->getBufferSize() / sizeof(uint64_t);
+    std::vector<uint64_t> values(size);
+    std::memcpy(values.data(), (*buffer)->getBufferStart(), size * sizeof(uint64_t));
+
+    if (size < 2 || values[0] != SAMPLES_MAGIC || values[1] != SAMPLES_VERSION)
+    {
+        result.errors = "Invalid samples file '" + samples_file + "'.\n";
+        return result;
+    }
+
+    for (size_t i = 2; i < size;)
+    {
+        auto length = values[i];
+        auto name_size = (length + 7) / 8;
+
+        if (i + 2 + name_size > size || i + 2 + name_size + values[i + 1 + name_size] * 4 > size)
+        {
+            result.errors = "Truncated samples file '" + samples_file + "'.\n";
+            return result;
+        }
+
+        Benchmark benchmark;
+        benchmark.name = std::string(reinterpret_cast<const char *>(&values[i + 1]), length);
+        benchmark.samples = values[i + 1 + name_size];
+
+        // Nanoseconds per iteration of each sample
+        std::vector<double> timings;
+        uint64_t nanoseconds = 0;
+        uint64_t cycles = 0;
+        uint64_t allocations = 0;
+
+        for (size_t j = 0; j < benchmark.samples; j++)
+        {
+            auto sample = &values[i + 2 + name_size + j * 4];
+
+            benchmark.iterations += sample[0];
+            nanoseconds += sample[1];
+            cycles += sample[2];
+            allocations += sample[3];
+
+            timings.push_back(static_cast<double>(sample[1]) / std::max<uint64_t>(sample[0], 1));
+        }
+
+        if (!timings.empty())
+        {
+            std::sort(timings.begin(), timings.end());
+
+            auto middle = timings.size() / 2;
+            benchmark.median = timings.size() % 2 == 0 ? (timings[middle - 1] + timings[middle]) / 2 : timings[middle];
+
+            // Nearest rank
+            benchmark.p99 = timings[static_cast<size_t>(std::ceil(0.99 * timings.size())) - 1];
+
+            auto iterations = static_cast<double>(std::max<uint64_t>(benchmark.iterations, 1));
+            benchmark.mean = nanoseconds / iterations;
+            benchmark.cycles = cycles / iterations;
+            benchmark.allocations = allocations / iterations;
+        }
+
+        result.benchmarks.push_back(benchmark);
+
+        i += 2 + name_size + benchmark.samples * 4;
+    }
+
+    result.success = true;
+    return result;
+}
+
+BenchmarkResult Benchmarks::read_baseline(const std::string &baseline_file)
+{
+    BenchmarkResult result;
+
+    auto buffer = llvm::MemoryBuffer::getFile(baseline_file);
+
+    if (!buffer)
+    {
+        result.errors = "Could not read the baseline '" + baseline_file + "', " + buffer.getError().message() + ".\n";
+        return result;
+    }
+
+    auto json = llvm::json::parse((*buffer)->getBuffer());
+
+    if (!json)
+    {
+        result.errors = "Invalid baseline '" + baseline_file + "', " + llvm::toString(json.takeError()) + ".\n";
+        return result;
+    }
+
+    auto root = json->getAsObject();
+    auto benchmarks = root != nullptr ? root->getArray("benchmarks") : nullptr;
+
+    if (benchmarks == nullptr || root->getInteger("version") != BASELINE_VERSION)
+    {
+        result.errors = "Invalid baseline '" + baseline_file + "'.\n";
+        return result;
+    }
+
+    for (const auto &value : *benchmarks)
+    {
+        auto object = value.getAsObject();
+
+        if (object == nullptr || !object->getString("name"))
+        {
+            continue;
+        }
+
+        Benchmark benchmark;
+        benchmark.name = object->getString("name")->str();
+        benchmark.samples = object->getInteger("samples").getValueOr(0);
+        benchmark.iterations = object->getInteger("iterations").getValueOr(0);
+        benchmark.mean = object->getNumber("mean").getValueOr(0);
+        benchmark.median = object->getNumber("median").getValueOr(0);
+        benchmark.p99 = object->getNumber("p99").getValueOr(0);
+        benchmark.cycles = object->getNumber("cycles").getValueOr(0);
+        benchmark.allocations = object->getNumber("allocations").getValueOr(0);
+
+        result.benchmarks.push_back(benchmark);
+    }
+
+    result.success = true;
+    return result;
+}
+
+bool Benchmarks::write_baseline(const std::string &baseline_file, const std::vector<Benchmark> &benchmarks, std::string &errors)
+{
+    llvm::json::Array array;
+
+    for (const auto &benchmark : benchmarks)
+    {
+        array.push_back(llvm::json::Object{
+            {"name", benchmark.name},
+            {"samples", static_cast<int64_t>(benchmark.samples)},
+            {"iterations", static_cast<int64_t>(benchmark.iterations)},
+            {"mean", benchmark.mean},
+            {"median", benchmark.median},
+            {"p99", benchmark.p99},
+            {"cycles", benchmark.cycles},
+            {"allocations", benchmark.allocations},
+        });
+    }
+
+    std::error_code error;
+    llvm::raw_fd_ostream out(baseline_file, error);
+
+    if (error)
+    {
+        errors = "Could not write the baseline '" + baseline_file + "', " + error.message() + ".\n";
+        return false;
+    }
+
+    out << llvm::formatv("{0:2}", llvm::json::Value(llvm::json::Object{{"version", BASELINE_VERSION}, {"benchmarks", std::move(array)}})) << '\n';
+
+    return true;
+}
+
+std::string Benchmarks::report(const std::vector<Benchmark> &benchmarks, const std::vector<Benchmark> &baseline, const double &threshold, unsigned &regressions)
+{
+    std::string str;
+    llvm::raw_string_ostream out(str);
+
+    size_t width = 4;
+
+    for (const auto &benchmark : benchmarks)
+    {
+        width = std::max(width, benchmark.name.size());
+    }
+
+    out << llvm::left_justify("name", width) << llvm::right_justify("mean", 12) << llvm::right_justify("median", 12) << llvm::right_justify("p99", 12) << llvm::right_justify("cycles", 12)
+        << llvm::right_justify("allocs", 10) << llvm::right_justify("samples", 9);
+
+    if (!baseline.empty())
+    {
+        out << "  baseline";
+    }
+
+    out << '\n';
+
+    for (const auto &benchmark : benchmarks)
+    {
+        out << llvm::left_justify(benchmark.name, width) << llvm::right_justify(format_duration(benchmark.mean), 12) << llvm::right_justify(format_duration(benchmark.median), 12)
+            << llvm::right_justify(format_duration(benchmark.p99), 12) << llvm::format("%12.1f", benchmark.cycles) << llvm::format("%10.2f", benchmark.allocations)
+            << llvm::format("%9llu", static_cast<unsigned long long>(benchmark.samples));
+
+        auto base = std::find_if(baseline.begin(), baseline.end(), [&](const Benchmark &base) { return base.name == benchmark.name; });
+
+        if (base != baseline.end() && base->median > 0)
+        {
+            auto change = benchmark.median / base->median - 1;
+
+            out << llvm::format("  %+.1f%%", change * 100);
+
+            if (change > threshold)
+            {
+                out << " regression";
+                regressions++;
+            }
+            else if (change < -threshold)
+            {
+                out << " improvement";
+            }
+        }
+        else if (!baseline.empty())
+        {
+            out << "  new";
+        }
+
+        out << '\n';
+    }
+
+    return out.str();
+}
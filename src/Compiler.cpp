@@ -1,12 +1,32 @@
 #include <Sand/Compiler.hpp>
 
 #include <Sand/Helpers.hpp>
+#include <Sand/Stats.hpp>
+#include <Sand/ThroughputAnalyzer.hpp>
+
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringExtras.h>
+
+#include <llvm/Analysis/ModuleSummaryAnalysis.h>
+
+#include <llvm/BinaryFormat/Magic.h>
+
+#include <llvm/Bitcode/BitcodeWriter.h>
+
+#include <llvm/CodeGen/ParallelCG.h>
 
 #include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/PassManager.h>
+#include <llvm/IR/RemarkStreamer.h>
+
+#include <llvm/LTO/Caching.h>
+#include <llvm/LTO/LTO.h>
+
 #include <llvm/Passes/PassBuilder.h>
 
+#include <llvm/Support/CommandLine.h>
 #include <llvm/Support/FileSystem.h>
+#include <llvm/Support/SmallVectorMemoryBuffer.h>
 #include <llvm/Support/PrettyStackTrace.h>
 #include <llvm/Support/TargetRegistry.h>
 #include <llvm/Support/TargetSelect.h>
@@ -15,14 +35,25 @@
 
 #include <llvm/Target/TargetMachine.h>
 
+#include <llvm/Transforms/IPO/AlwaysInliner.h>
 #include <llvm/Transforms/InstCombine/InstCombine.h>
+#include <llvm/Transforms/Instrumentation/InstrProfiling.h>
+#include <llvm/Transforms/Instrumentation/PGOInstrumentation.h>
 #include <llvm/Transforms/ObjCARC.h>
 #include <llvm/Transforms/Scalar.h>
 #include <llvm/Transforms/Scalar/GVN.h>
+#include <llvm/Transforms/Scalar/SROA.h>
+#include <llvm/Transforms/Scalar/SimplifyCFG.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+#include <llvm/Transforms/Utils/Mem2Reg.h>
+#include <llvm/Transforms/Utils/ModuleUtils.h>
 
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <set>
 
-std::vector<std::string> Sand::Compiler::generate_objects(const std::string &os, const std::string &arch, const llvm::PassBuilder::OptimizationLevel &optimization_level, const bool &verbose)
+std::vector<std::string> Sand::Compiler::generate_objects(const std::string &os, const std::string &arch, const llvm::PassBuilder::OptimizationLevel &optimization_level, const bool &verbose, const unsigned &jobs)
 {
     if (verbose)
     {
@@ -30,6 +61,39 @@ std::vector<std::string> Sand::Compiler::generate_objects(const std::string &os,
         std::cout << "Target triple: " << this->module->getTargetTriple() << std::endl;
     }
 
+    if (this->bench && !this->generate_bench_driver())
+    {
+        return {};
+    }
+
+    auto analyzed_functions = this->get_analyzed_functions();
+
+    // Analyzed functions are kept even when they are inlined everywhere
+    if (!analyzed_functions.empty())
+    {
+        std::vector<llvm::GlobalValue *> used;
+
+        for (const auto &name : analyzed_functions)
+        {
+            used.push_back(this->module->getFunction(name));
+        }
+
+        llvm::appendToCompilerUsed(*this->module, used);
+    }
+
+    this->optimize(optimization_level, verbose);
+    this->order_functions();
+
+    if (!analyzed_functions.empty())
+    {
+        this->analyze_throughput(optimization_level);
+    }
+
+    if (jobs > 1)
+    {
+        return this->generate_objects_parallel(optimization_level, jobs);
+    }
+
     auto output_path = Helpers::temporary_filename();
     std::error_code error_code;
     llvm::raw_fd_ostream dest(output_path, error_code, llvm::sys::fs::OF_None);
@@ -40,23 +104,679 @@ std::vector<std::string> Sand::Compiler::generate_objects(const std::string &os,
         return {};
     }
 
-    if (optimization_level != llvm::PassBuilder::OptimizationLevel::O0)
+    if (!this->emit(dest, optimization_level))
+    {
+        return {};
+    }
+
+    dest.flush();
+
+    return {output_path};
+}
+
+std::unique_ptr<llvm::MemoryBuffer> Sand::Compiler::generate_object_buffer(const llvm::PassBuilder::OptimizationLevel &optimization_level)
+{
+    llvm::SmallVector<char, 0> buffer;
+    llvm::raw_svector_ostream dest(buffer);
+
+    this->optimize(optimization_level, false);
+
+    if (!this->emit(dest, optimization_level))
+    {
+        return nullptr;
+    }
+
+    return std::make_unique<llvm::SmallVectorMemoryBuffer>(std::move(buffer), this->module->getModuleIdentifier() + ".o");
+}
+
+std::vector<std::string> Sand::Compiler::generate_bitcode(const llvm::PassBuilder::OptimizationLevel &optimization_level, const bool &verbose)
+{
+    this->optimize(optimization_level, verbose, true);
+
+    // The section prefixes are kept in the bitcode, the ordering lists the functions of this module
+    this->order_functions();
+
+    auto output_path = Helpers::temporary_filename();
+    std::error_code error_code;
+    llvm::raw_fd_ostream dest(output_path, error_code, llvm::sys::fs::OF_None);
+
+    if (error_code)
+    {
+        llvm::errs() << "Could not open file: " << error_code.message();
+        return {};
+    }
+
+    auto index = llvm::buildModuleSummaryIndex(*this->module, nullptr, nullptr);
+    llvm::WriteBitcodeToFile(*this->module, dest, false, &index);
+
+    dest.flush();
+
+    return {output_path};
+}
+
+static unsigned get_lto_optimization_level(const llvm::PassBuilder::OptimizationLevel &optimization_level)
+{
+    if (optimization_level == llvm::PassBuilder::OptimizationLevel::O0)
+        return 0;
+
+    if (optimization_level == llvm::PassBuilder::OptimizationLevel::O1)
+        return 1;
+
+    if (optimization_level == llvm::PassBuilder::OptimizationLevel::O3)
+        return 3;
+
+    return 2;
+}
+
+std::vector<std::string> Sand::Compiler::thin_link(const std::vector<std::string> &inputs, const llvm::PassBuilder::OptimizationLevel &optimization_level, const unsigned &jobs, const std::string &cache_directory)
+{
+    llvm::lto::Config config;
+    config.CPU = this->target_machine->getTargetCPU();
+    config.Options = this->target_machine->Options;
+    config.RelocModel = this->target_machine->getRelocationModel();
+    config.CodeModel = this->target_machine->getCodeModel();
+    config.CGOptLevel = this->target_machine->getOptLevel();
+    config.OptLevel = get_lto_optimization_level(optimization_level);
+    config.UseNewPM = true;
+
+    // Every backend thread writes its remarks next to the remarks file
+    config.RemarksFilename = this->remarks_file;
+    config.RemarksPasses = this->get_remarks_passes();
+    config.RemarksFormat = this->remarks_format;
+    config.RemarksWithHotness = !this->profile_use.empty();
+
+    llvm::SmallVector<llvm::StringRef, 8> features;
+    llvm::SplitString(this->target_machine->getTargetFeatureString(), features, ",");
+
+    for (const auto &feature : features)
+    {
+        config.MAttrs.push_back(feature.str());
+    }
+
+    llvm::lto::LTO lto(std::move(config), llvm::lto::createInProcessThinBackend(std::max(jobs, 1U)));
+
+    std::vector<std::string> output_paths;
+    std::vector<std::unique_ptr<llvm::MemoryBuffer>> buffers;
+
+    // Every module carries its own copy of the builtins, the first definition of a symbol is kept
+    std::set<std::string> defined;
+
+    std::vector<std::string> bitcode_inputs;
+
+    for (const auto &input : inputs)
+    {
+        auto buffer = llvm::MemoryBuffer::getFile(input);
+
+        if (!buffer)
+        {
+            llvm::errs() << "Could not open file: " << input << ": " << buffer.getError().message() << "\n";
+            return {};
+        }
+
+        if (llvm::identify_magic((*buffer)->getBuffer()) != llvm::file_magic::bitcode)
+        {
+            output_paths.push_back(input);
+            continue;
+        }
+
+        bitcode_inputs.push_back(input);
+        buffers.push_back(std::move(*buffer));
+    }
+
+    // Object files linked with the modules (C, or Sand modules built without --lto=thin) may call any of their exports
+    auto has_regular_objects = !output_paths.empty();
+
+    for (size_t i = 0; i < buffers.size(); i++)
+    {
+        const auto &input = bitcode_inputs[i];
+        auto file = llvm::lto::InputFile::create(buffers[i]->getMemBufferRef());
+
+        if (!file)
+        {
+            llvm::errs() << "Invalid bitcode file: " << input << ": " << llvm::toString(file.takeError()) << "\n";
+            return {};
+        }
+
+        std::vector<llvm::lto::SymbolResolution> resolutions;
+
+        for (const auto &symbol : (*file)->symbols())
+        {
+            llvm::lto::SymbolResolution resolution;
+
+            if (!symbol.isUndefined())
+            {
+                resolution.Prevailing = defined.insert(symbol.getName().str()).second;
+            }
+
+            // Without object files, only the entry point is called from outside of the Sand modules
+            resolution.VisibleToRegularObj = symbol.getName() == "main"
+                                             || (has_regular_objects && !symbol.isUndefined() && symbol.getVisibility() == llvm::GlobalValue::DefaultVisibility);
+
+            resolutions.push_back(resolution);
+        }
+
+        if (auto error = lto.add(std::move(*file), resolutions))
+        {
+            llvm::errs() << "Could not add file: " << input << ": " << llvm::toString(std::move(error)) << "\n";
+            return {};
+        }
+    }
+
+    std::vector<std::string> objects(lto.getMaxTasks());
+
+    auto add_stream = [&](size_t task) -> std::unique_ptr<llvm::lto::NativeObjectStream> {
+        objects[task] = Helpers::temporary_filename();
+
+        std::error_code error_code;
+        auto stream = std::make_unique<llvm::raw_fd_ostream>(objects[task], error_code, llvm::sys::fs::OF_None);
+
+        if (error_code)
+        {
+            llvm::report_fatal_error("Could not open file: " + error_code.message());
+        }
+
+        return std::make_unique<llvm::lto::NativeObjectStream>(std::move(stream));
+    };
+
+    llvm::NativeObjectCache cache;
+
+    if (!cache_directory.empty())
+    {
+        // Objects found in the cache are copied out of it, the cache may be pruned at any time
+        auto local_cache = llvm::localCache(cache_directory, [&](size_t task, std::unique_ptr<llvm::MemoryBuffer> buffer) {
+            auto stream = add_stream(task);
+            *stream->OS << buffer->getBuffer();
+        });
+
+        if (!local_cache)
+        {
+            llvm::errs() << "Could not use the ThinLTO cache: " << llvm::toString(local_cache.takeError()) << "\n";
+            return {};
+        }
+
+        cache = std::move(*local_cache);
+    }
+
+    if (auto error = lto.run(add_stream, cache))
+    {
+        llvm::errs() << "ThinLTO failed: " << llvm::toString(std::move(error)) << "\n";
+        return {};
+    }
+
+    for (const auto &object : objects)
+    {
+        if (!object.empty())
+        {
+            output_paths.push_back(object);
+        }
+    }
+
+    return output_paths;
+}
+
+void Sand::Compiler::optimize(const llvm::PassBuilder::OptimizationLevel &optimization_level, const bool &verbose, const bool &thin_lto)
+{
+    llvm::TimeTraceScope time_scope("Optimize", this->module->getName());
+    Stats::Phase phase("optimize");
+
+    llvm::Optional<llvm::PGOOptions> pgo_options;
+
+    if (this->profile_generate)
+    {
+        pgo_options = llvm::PGOOptions("default.profraw", "", "", llvm::PGOOptions::IRInstr);
+    }
+    else if (!this->profile_use.empty())
+    {
+        pgo_options = llvm::PGOOptions(this->profile_use, "", "", llvm::PGOOptions::IRUse);
+    }
+
+    if (this->xray)
+    {
+        this->instrument_xray();
+    }
+
+    if (this->frame_pointers)
+    {
+        for (auto &function : *this->module)
+        {
+            if (!function.isDeclaration())
+            {
+                function.addFnAttr("frame-pointer", "all");
+            }
+        }
+    }
+
+    this->register_runtimes();
+
+    if (this->fast_debug)
+    {
+        this->select_fast_instructions();
+    }
+
+    auto remarks = this->open_remarks();
+
+    // Each top-level pass is a phase of --stats
+    llvm::PassInstrumentationCallbacks callbacks;
+
+    if (Stats::enabled)
+    {
+        Stats::register_callbacks(callbacks);
+    }
+
+    llvm::PassBuilder builder(nullptr, llvm::PipelineTuningOptions(), pgo_options, &callbacks);
+    llvm::LoopAnalysisManager loop_analisys_manager(verbose);
+    llvm::FunctionAnalysisManager function_analisys_manager(verbose);
+    llvm::CGSCCAnalysisManager CGSCC_analisys_manager(verbose);
+    llvm::ModuleAnalysisManager module_analisys_manager(verbose);
+
+    builder.registerModuleAnalyses(module_analisys_manager);
+    builder.registerCGSCCAnalyses(CGSCC_analisys_manager);
+    builder.registerFunctionAnalyses(function_analisys_manager);
+    builder.registerLoopAnalyses(loop_analisys_manager);
+    builder.crossRegisterProxies(loop_analisys_manager, function_analisys_manager, CGSCC_analisys_manager, module_analisys_manager);
+
+    llvm::ModulePassManager module_pass_manager(verbose);
+
+    if (optimization_level == llvm::PassBuilder::OptimizationLevel::O0)
+    {
+        // #[inline] functions are always inlined, even without optimizations.
+        // With -Og, they are inlined first so their allocas are promoted too
+        module_pass_manager.addPass(llvm::AlwaysInlinerPass());
+
+        if (this->fast_debug)
+        {
+            // The arguments and locals are spilled to allocas by the Visitor, promoting them is most of the speedup of an optimized build
+            llvm::FunctionPassManager function_pass_manager(verbose);
+            function_pass_manager.addPass(llvm::SROA());
+            function_pass_manager.addPass(llvm::PromotePass());
+            function_pass_manager.addPass(llvm::SimplifyCFGPass());
+
+            module_pass_manager.addPass(llvm::createModuleToFunctionPassAdaptor(std::move(function_pass_manager)));
+        }
+
+        if (this->profile_generate)
+        {
+            // The default pipelines only instrument optimized builds
+            llvm::InstrProfOptions instrumentation_options;
+            instrumentation_options.InstrProfileOutput = "default.profraw";
+
+            module_pass_manager.addPass(llvm::PGOInstrumentationGen());
+            module_pass_manager.addPass(llvm::InstrProfiling(instrumentation_options));
+        }
+    }
+    else if (thin_lto)
+    {
+        // Before a ThinLTO link, inlining across modules and the late passes are left to the backends
+        module_pass_manager = builder.buildThinLTOPreLinkDefaultPipeline(optimization_level, verbose);
+    }
+    else
+    {
+        module_pass_manager = builder.buildPerModuleDefaultPipeline(optimization_level, verbose);
+    }
+
+    // The std runtime writes the counters only, indirect call targets and memory operation sizes are not profiled.
+    // The option is global to the process, it is restored for the next compilations (--server, Session)
+    llvm::cl::opt<bool> *disable_value_profiling = nullptr;
+    bool disabled_value_profiling = false;
+
+    if (this->profile_generate)
+    {
+        auto &options = llvm::cl::getRegisteredOptions();
+        auto option = options.find("disable-vp");
+
+        if (option != options.end())
+        {
+            disable_value_profiling = static_cast<llvm::cl::opt<bool> *>(option->second);
+            disabled_value_profiling = disable_value_profiling->getValue();
+            disable_value_profiling->setValue(true);
+        }
+    }
+
+    module_pass_manager.run(*module, module_analisys_manager);
+
+    if (disable_value_profiling != nullptr)
+    {
+        disable_value_profiling->setValue(disabled_value_profiling);
+    }
+
+    if (remarks)
+    {
+        remarks->keep();
+        this->module->getContext().setRemarkStreamer(nullptr);
+    }
+}
+
+void Sand::Compiler::select_fast_instructions()
+{
+    if (this->fast_target_machine != nullptr)
+    {
+        return;
+    }
+
+    auto target_machine = this->target_machine;
+
+    this->fast_target_machine.reset(target_machine->getTarget().createTargetMachine(target_machine->getTargetTriple().str(),
+                                                                                    target_machine->getTargetCPU(),
+                                                                                    target_machine->getTargetFeatureString(),
+                                                                                    target_machine->Options,
+                                                                                    target_machine->getRelocationModel(),
+                                                                                    target_machine->getCodeModel(),
+                                                                                    llvm::CodeGenOpt::None));
+
+    // GlobalISel falls back to SelectionDAG for most functions on x86 in this LLVM, FastISel is the fastest selector here
+    this->fast_target_machine->setFastISel(true);
+    this->target_machine = this->fast_target_machine.get();
+}
+
+std::vector<std::string> Sand::Compiler::get_analyzed_functions() const
+{
+    std::vector<std::string> names;
+
+    for (auto &function : *this->module)
+    {
+        auto name = function.getName().str();
+
+        if (function.isDeclaration())
+        {
+            continue;
+        }
+
+        if (function.hasFnAttribute("sand-analyze") || std::find(this->mca_functions.begin(), this->mca_functions.end(), name) != this->mca_functions.end())
+        {
+            names.push_back(name);
+        }
+    }
+
+    return names;
+}
+
+void Sand::Compiler::analyze_throughput(const llvm::PassBuilder::OptimizationLevel &optimization_level)
+{
+    // Code generation changes the module, the assembly is generated from a copy
+    auto clone = llvm::CloneModule(*this->module);
+    Compiler compiler(clone, this->target_machine);
+
+    llvm::SmallString<0> assembly;
+    llvm::raw_svector_ostream stream(assembly);
+
+    if (!compiler.emit(stream, optimization_level, llvm::CGFT_AssemblyFile))
+    {
+        return;
+    }
+
+    // Requested functions that don't exist are reported as not found
+    auto names = this->get_analyzed_functions();
+
+    for (const auto &name : this->mca_functions)
     {
-        llvm::PassBuilder builder;
-        llvm::LoopAnalysisManager loop_analisys_manager(verbose);
-        llvm::FunctionAnalysisManager function_analisys_manager(verbose);
-        llvm::CGSCCAnalysisManager CGSCC_analisys_manager(verbose);
-        llvm::ModuleAnalysisManager module_analisys_manager(verbose);
+        if (std::find(names.begin(), names.end(), name) == names.end())
+        {
+            names.push_back(name);
+        }
+    }
+
+    ThroughputAnalyzer analyzer(this->target_machine);
+    this->mca_report = analyzer.analyze(assembly.str().str(), names);
+}
 
-        builder.registerModuleAnalyses(module_analisys_manager);
-        builder.registerCGSCCAnalyses(CGSCC_analisys_manager);
-        builder.registerFunctionAnalyses(function_analisys_manager);
-        builder.registerLoopAnalyses(loop_analisys_manager);
-        builder.crossRegisterProxies(loop_analisys_manager, function_analisys_manager, CGSCC_analisys_manager, module_analisys_manager);
+void Sand::Compiler::instrument_xray()
+{
+    auto threshold = std::to_string(this->xray_threshold);
 
-        llvm::ModulePassManager module_pass_manager = builder.buildPerModuleDefaultPipeline(optimization_level, verbose);
-        module_pass_manager.run(*module, module_analisys_manager);
+    for (auto &function : *this->module)
+    {
+        // `#[xray = "always"]` and `#[xray = "never"]` already decided
+        if (!function.isDeclaration() && !function.hasFnAttribute("function-instrument"))
+        {
+            function.addFnAttr("xray-instruction-threshold", threshold);
+        }
     }
+}
+
+void Sand::Compiler::register_runtimes()
+{
+    // Runtimes loaded from std by --profile-generate, --xray, `sand profile` and `sand bench`
+    for (const auto &name : {"__sand_xray_init", "__sand_sampler_init", "__sand_bench_init"})
+    {
+        if (auto init = this->module->getFunction(name))
+        {
+            llvm::appendToGlobalCtors(*this->module, init, 0);
+        }
+    }
+
+    for (const auto &name : {"__sand_profile_finish", "__sand_xray_finish", "__sand_sampler_finish", "__sand_bench_finish"})
+    {
+        if (auto finish = this->module->getFunction(name))
+        {
+            llvm::appendToGlobalDtors(*this->module, finish, 0);
+        }
+    }
+
+    // Only referenced from assembly
+    std::vector<llvm::GlobalValue *> used;
+
+    for (const auto &name : {"__sand_xray_trampolines", "__sand_xray_handle", "__sand_sampler_trampolines", "__sand_sampler_handle"})
+    {
+        if (auto function = this->module->getFunction(name))
+        {
+            used.push_back(function);
+        }
+    }
+
+    if (!used.empty())
+    {
+        llvm::appendToUsed(*this->module, used);
+    }
+}
+
+bool Sand::Compiler::generate_bench_driver()
+{
+    auto begin = this->module->getFunction("__sand_bench_begin");
+    auto iterations = this->module->getFunction("__sand_bench_iterations");
+    auto end = this->module->getFunction("__sand_bench_end");
+
+    if (begin == nullptr || iterations == nullptr || end == nullptr)
+    {
+        llvm::errs() << "The benchmark runtime (std/bench.sn) is not loaded\n";
+        return false;
+    }
+
+    std::vector<llvm::Function *> benchmarks;
+
+    for (auto &function : *this->module)
+    {
+        if (function.isDeclaration() || !function.hasFnAttribute("sand-bench"))
+        {
+            continue;
+        }
+
+        if (function.arg_size() != 0)
+        {
+            llvm::errs() << "Benchmark '" << function.getName() << "' is skipped, it should not take arguments\n";
+            continue;
+        }
+
+        if (function.getName().contains(this->bench_filter))
+        {
+            benchmarks.push_back(&function);
+        }
+    }
+
+    // The program's own main is replaced by the driver
+    if (auto main = this->module->getFunction("main"))
+    {
+        main->setName("__sand_bench_program_main");
+        main->setLinkage(llvm::GlobalValue::InternalLinkage);
+    }
+
+    auto &context = this->module->getContext();
+    llvm::IRBuilder<> builder(context);
+
+    auto u64 = builder.getInt64Ty();
+    auto driver = llvm::Function::Create(llvm::FunctionType::get(builder.getInt32Ty(), false), llvm::GlobalValue::ExternalLinkage, "main", *this->module);
+
+    builder.SetInsertPoint(llvm::BasicBlock::Create(context, "entry", driver));
+
+    for (auto benchmark : benchmarks)
+    {
+        // Benchmarks are called through a volatile load: they are neither inlined in the loop nor removed when they look pure
+        auto pointer = new llvm::GlobalVariable(*this->module, benchmark->getType(), false, llvm::GlobalValue::InternalLinkage, benchmark, "__sand_bench_" + benchmark->getName());
+
+        builder.CreateCall(begin, {builder.CreateGlobalStringPtr(benchmark->getName())});
+
+        auto sample = llvm::BasicBlock::Create(context, "sample", driver);
+        auto loop = llvm::BasicBlock::Create(context, "loop", driver);
+        auto sample_end = llvm::BasicBlock::Create(context, "sample.end", driver);
+        auto done = llvm::BasicBlock::Create(context, "done", driver);
+
+        builder.CreateBr(sample);
+        builder.SetInsertPoint(sample);
+
+        auto count = builder.CreateCall(iterations);
+        auto callee = builder.CreateLoad(pointer, true);
+        builder.CreateCondBr(builder.CreateICmpEQ(count, llvm::ConstantInt::get(u64, 0)), done, loop);
+
+        builder.SetInsertPoint(loop);
+
+        auto index = builder.CreatePHI(u64, 2);
+        index->addIncoming(llvm::ConstantInt::get(u64, 0), sample);
+
+        builder.CreateCall(benchmark->getFunctionType(), callee);
+
+        auto next = builder.CreateAdd(index, llvm::ConstantInt::get(u64, 1));
+        index->addIncoming(next, loop);
+        builder.CreateCondBr(builder.CreateICmpULT(next, count), loop, sample_end);
+
+        builder.SetInsertPoint(sample_end);
+        builder.CreateCall(end);
+        builder.CreateBr(sample);
+
+        builder.SetInsertPoint(done);
+    }
+
+    builder.CreateRet(builder.getInt32(0));
+
+    for (auto benchmark : benchmarks)
+    {
+        this->bench_functions.push_back(benchmark->getName().str());
+    }
+
+    return true;
+}
+
+std::string Sand::Compiler::get_remarks_passes() const
+{
+    if (this->remarks_passes.empty())
+    {
+        return "";
+    }
+
+    return "^(" + llvm::join(this->remarks_passes, "|") + ")$";
+}
+
+std::unique_ptr<llvm::ToolOutputFile> Sand::Compiler::open_remarks()
+{
+    if (this->remarks_file.empty())
+    {
+        return nullptr;
+    }
+
+    // Hotness comes from the profile, when there is one
+    auto remarks = llvm::setupOptimizationRemarks(this->module->getContext(), this->remarks_file, this->get_remarks_passes(), this->remarks_format, !this->profile_use.empty());
+
+    if (!remarks)
+    {
+        llvm::errs() << "Could not write optimization remarks: " << llvm::toString(remarks.takeError()) << "\n";
+        return nullptr;
+    }
+
+    return std::move(*remarks);
+}
+
+void Sand::Compiler::order_functions()
+{
+    if (!this->order_symbols || (this->call_trace.empty() && this->profile_use.empty()))
+    {
+        return;
+    }
+
+    std::map<std::string, uint64_t> weights;
+
+    if (!this->call_trace.empty())
+    {
+        std::ifstream stream(this->call_trace);
+        std::string line;
+
+        while (std::getline(stream, line))
+        {
+            uint64_t count = 1;
+            auto frames = line;
+            auto separator = line.find_last_of(' ');
+
+            if (separator != std::string::npos)
+            {
+                count = std::strtoull(line.c_str() + separator + 1, nullptr, 10);
+                frames = line.substr(0, separator);
+            }
+
+            llvm::SmallVector<llvm::StringRef, 16> symbols;
+            llvm::SplitString(frames, symbols, ";");
+
+            for (const auto &symbol : symbols)
+            {
+                weights[symbol.str()] += count;
+            }
+        }
+
+        for (auto &function : *this->module)
+        {
+            // #[hot] and #[cold] functions keep their section
+            if (function.isDeclaration() || function.getSectionPrefix().hasValue())
+            {
+                continue;
+            }
+
+            function.setSectionPrefix(weights.count(function.getName().str()) ? ".hot" : ".unlikely");
+        }
+    }
+    else
+    {
+        // With a profile, the optimizer already moved the functions to their hot or cold section
+        for (auto &function : *this->module)
+        {
+            auto count = function.getEntryCount();
+
+            if (!function.isDeclaration() && count.hasValue() && count.getCount() > 0)
+            {
+                weights[function.getName().str()] = count.getCount();
+            }
+        }
+    }
+
+    if (weights.empty())
+    {
+        return;
+    }
+
+    std::vector<std::pair<std::string, uint64_t>> symbols(weights.begin(), weights.end());
+
+    std::stable_sort(symbols.begin(), symbols.end(), [](const auto &left, const auto &right) {
+        return left.second > right.second;
+    });
+
+    this->symbol_ordering_file = Helpers::temporary_filename();
+    std::ofstream stream(this->symbol_ordering_file);
+
+    for (const auto &[symbol, _] : symbols)
+    {
+        stream << symbol << '\n';
+    }
+}
+
+bool Sand::Compiler::emit(llvm::raw_pwrite_stream &dest, const llvm::PassBuilder::OptimizationLevel &optimization_level, const llvm::CodeGenFileType &file_type)
+{
+    llvm::TimeTraceScope time_scope("CodeGen", this->module->getName());
+    Stats::Phase phase("codegen");
 
     llvm::legacy::PassManager pass;
     pass.add(llvm::createTargetTransformInfoWrapperPass(this->target_machine->getTargetIRAnalysis()));
@@ -66,8 +786,6 @@ std::vector<std::string> Sand::Compiler::generate_objects(const std::string &os,
 
     pass.add(new llvm::TargetLibraryInfoWrapperPass(*tlii));
 
-    llvm::CodeGenFileType file_type = llvm::CGFT_ObjectFile;
-
     if (optimization_level != llvm::PassBuilder::OptimizationLevel::O0)
     {
         pass.add(llvm::createObjCARCContractPass());
@@ -76,11 +794,68 @@ std::vector<std::string> Sand::Compiler::generate_objects(const std::string &os,
     if (this->target_machine->addPassesToEmitFile(pass, dest, nullptr, file_type))
     {
         llvm::errs() << "TargetMachine can't emit a file of this type";
-        return {};
+        return false;
     }
 
     pass.run(*this->module);
-    dest.flush();
 
-    return {output_path};
+    return true;
+}
+
+std::vector<std::string> Sand::Compiler::generate_objects_parallel(const llvm::PassBuilder::OptimizationLevel &optimization_level, const unsigned &jobs)
+{
+    std::vector<std::string> output_paths;
+    std::vector<std::unique_ptr<llvm::raw_fd_ostream>> streams;
+    std::vector<llvm::raw_pwrite_stream *> outputs;
+
+    for (unsigned i = 0; i < jobs; i++)
+    {
+        auto output_path = Helpers::temporary_filename();
+        std::error_code error_code;
+
+        auto stream = std::make_unique<llvm::raw_fd_ostream>(output_path, error_code, llvm::sys::fs::OF_None);
+
+        if (error_code)
+        {
+            llvm::errs() << "Could not open file: " << error_code.message();
+
+            // The partitions opened so far are empty files
+            streams.clear();
+
+            for (const auto &path : output_paths)
+            {
+                llvm::sys::fs::remove(path);
+            }
+
+            return {};
+        }
+
+        outputs.push_back(stream.get());
+        streams.push_back(std::move(stream));
+        output_paths.push_back(output_path);
+    }
+
+    auto target_machine = this->target_machine;
+
+    // Each partition is generated on its own thread, in its own LLVMContext, with its own TargetMachine
+    auto create_target_machine = [target_machine]() {
+        return std::unique_ptr<llvm::TargetMachine>(target_machine->getTarget().createTargetMachine(target_machine->getTargetTriple().str(),
+                                                                                                    target_machine->getTargetCPU(),
+                                                                                                    target_machine->getTargetFeatureString(),
+                                                                                                    target_machine->Options,
+                                                                                                    target_machine->getRelocationModel(),
+                                                                                                    target_machine->getCodeModel(),
+                                                                                                    target_machine->getOptLevel()));
+    };
+
+    // The module is still used after code generation (--print-llvm), the partitions are made from a copy
+    Stats::Phase phase("codegen");
+    llvm::splitCodeGen(llvm::CloneModule(*this->module), outputs, {}, create_target_machine, llvm::CGFT_ObjectFile);
+
+    for (auto &stream : streams)
+    {
+        stream->flush();
+    }
+
+    return output_paths;
 }
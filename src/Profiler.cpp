@@ -0,0 +1,146 @@
+#include <Sand/Profiler.hpp>
+
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/DebugInfo/Symbolize/Symbolize.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <cstring>
+#include <map>
+#include <vector>
+
+using namespace Sand;
+
+// "SANDPROF"
+static constexpr uint64_t SAMPLES_MAGIC = 0x464f5250444e4153;
+static constexpr uint64_t SAMPLES_VERSION = 1;
+
+ProfileResult Profiler::collapse(const std::string &samples_file, const std::string &executable, const std::string &output_file)
+{
+    ProfileResult result;
+
+    auto buffer = llvm::MemoryBuffer::getFile(samples_file);
+
+    if (!buffer)
+    {
+        result.errors = "Could not read the samples of the program, " + buffer.getError().message() + ".\n";
+        return result;
+    }
+
+    auto size = (*buffer)->getBufferSize() / sizeof(uint64_t);
+    std::vector<uint64_t> values(size);
+    std::memcpy(values.data(), (*buffer)->getBufferStart(), size * sizeof(uint64_t));
+
+    if (size < 4 || values[0] != SAMPLES_MAGIC || values[1] != SAMPLES_VERSION)
+    {
+        result.errors = "Invalid samples file '" + samples_file + "'.\n";
+        return result;
+    }
+
+    result.dropped = values[3];
+
+    llvm::symbolize::LLVMSymbolizer::Options options;
+    options.Demangle = false;
+
+    llvm::symbolize::LLVMSymbolizer symbolizer(options);
+
+    // Frames of an address, from the outermost inlined call
+    std::map<uint64_t, std::vector<std::string>> symbols;
+
+    auto symbolize = [&](const uint64_t &address) -> const std::vector<std::string> & {
+        auto it = symbols.find(address);
+
+        if (it != symbols.end())
+        {
+            return it->second;
+        }
+
+        std::vector<std::string> names;
+        auto inlining = symbolizer.symbolizeInlinedCode(executable, {address, llvm::object::SectionedAddress::UndefSection});
+
+        if (inlining)
+        {
+            for (auto i = inlining->getNumberOfFrames(); i > 0; i--)
+            {
+                const auto &name = inlining->getFrame(i - 1).FunctionName;
+
+                if (name != llvm::DILineInfo::BadString)
+                {
+                    names.push_back(name);
+                }
+            }
+        }
+        else
+        {
+            llvm::consumeError(inlining.takeError());
+        }
+
+        if (names.empty())
+        {
+            names.push_back("0x" + llvm::utohexstr(address));
+        }
+
+        return symbols.emplace(address, std::move(names)).first->second;
+    };
+
+    std::map<std::string, uint64_t> stacks;
+
+    for (size_t i = 4; i + 2 <= size;)
+    {
+        auto count = values[i];
+        auto depth = values[i + 1];
+
+        if (i + 2 + depth > size)
+        {
+            result.errors = "Truncated samples file '" + samples_file + "'.\n";
+            return result;
+        }
+
+        std::string stack;
+
+        // From the root, return addresses point after their call
+        for (auto j = depth; j > 0; j--)
+        {
+            auto address = values[i + 2 + j - 1];
+
+            if (j > 1)
+            {
+                address--;
+            }
+
+            for (const auto &name : symbolize(address))
+            {
+                if (!stack.empty())
+                {
+                    stack += ';';
+                }
+
+                stack += name;
+            }
+        }
+
+        stacks[stack] += count;
+        result.samples += count;
+
+        i += 2 + depth;
+    }
+
+    std::error_code error;
+    llvm::raw_fd_ostream out(output_file, error);
+
+    if (error)
+    {
+        result.errors = "Could not write '" + output_file + "', " + error.message() + ".\n";
+        return result;
+    }
+
+    for (const auto &[stack, count] : stacks)
+    {
+        out << stack << ' ' << count << '\n';
+    }
+
+    result.stacks = stacks.size();
+    result.success = true;
+
+    return result;
+}
@@ -0,0 +1,282 @@
+#include <Sand/Repl.hpp>
+
+#include <Sand/Compiler.hpp>
+#include <Sand/Session.hpp>
+
+#include "grammar/Visitor.hpp"
+
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/Transforms/Utils/Cloning.h>
+
+#include <cstring>
+#include <sstream>
+
+using namespace Sand;
+
+template <typename T>
+static T read_value(const void *address)
+{
+    T value;
+    std::memcpy(&value, address, sizeof(T));
+
+    return value;
+}
+
+static std::string format_value(const void *address, Type *type)
+{
+    std::ostringstream stream;
+    auto ref = type->get_ref();
+
+    if (type->is_boolean())
+    {
+        stream << (read_value<uint8_t>(address) ? "true" : "false");
+    }
+    else if (type->is_integer())
+    {
+        auto bits = ref->getIntegerBitWidth();
+
+        int64_t signed_value = 0;
+        uint64_t unsigned_value = 0;
+
+        switch (bits)
+        {
+        case 8:
+            signed_value = read_value<int8_t>(address);
+            unsigned_value = read_value<uint8_t>(address);
+            break;
+        case 16:
+            signed_value = read_value<int16_t>(address);
+            unsigned_value = read_value<uint16_t>(address);
+            break;
+        case 32:
+            signed_value = read_value<int32_t>(address);
+            unsigned_value = read_value<uint32_t>(address);
+            break;
+        default:
+            signed_value = read_value<int64_t>(address);
+            unsigned_value = read_value<uint64_t>(address);
+            break;
+        }
+
+        if (type->is_signed)
+            stream << signed_value;
+        else
+            stream << unsigned_value;
+    }
+    else if (type->is_float())
+    {
+        stream << read_value<float>(address);
+    }
+    else if (type->is_double())
+    {
+        stream << read_value<double>(address);
+    }
+    else if (type->is_pointer())
+    {
+        auto pointer = read_value<const char *>(address);
+
+        if (pointer != nullptr && llvm::cast<llvm::PointerType>(ref)->getElementType()->isIntegerTy(8))
+        {
+            stream << '"' << pointer << '"';
+        }
+        else
+        {
+            stream << static_cast<const void *>(pointer);
+        }
+    }
+
+    stream << ": " << type->name;
+
+    return stream.str();
+}
+
+Repl::Repl(const std::string &target_os,
+           const std::string &target_arch,
+           const std::string &target_cpu,
+           const std::string &target_features,
+           const std::string &builtins_path,
+           const std::vector<std::string> &include_paths)
+{
+    Session::initialize_targets();
+
+    auto jit = llvm::orc::LLJITBuilder().create();
+
+    if (!jit)
+    {
+        throw std::runtime_error("Could not create the JIT: " + llvm::toString(jit.takeError()));
+    }
+
+    this->jit = std::move(*jit);
+
+    // The C library and the other symbols of the process are available to the inputs
+    auto generator = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(this->jit->getDataLayout().getGlobalPrefix());
+
+    if (!generator)
+    {
+        throw std::runtime_error("Could not load the process symbols: " + llvm::toString(generator.takeError()));
+    }
+
+    this->jit->getMainJITDylib().addGenerator(std::move(*generator));
+
+    this->visitor = std::make_unique<Visitor>(target_os, target_arch, target_cpu, target_features, builtins_path, include_paths);
+    this->visitor->load_builtins();
+}
+
+Repl::~Repl() = default;
+
+std::unique_ptr<llvm::Module> Repl::extract_new_definitions()
+{
+    auto module = llvm::CloneModule(*this->visitor->env.module);
+
+    auto extract = [this](llvm::GlobalObject &global) {
+        if (global.isDeclaration() || global.hasLocalLinkage())
+        {
+            return;
+        }
+
+        if (!this->emitted.insert(global.getName().str()).second)
+        {
+            // Compiled by a previous input, only declared
+            if (auto function = llvm::dyn_cast<llvm::Function>(&global))
+            {
+                function->deleteBody();
+            }
+            else
+            {
+                llvm::cast<llvm::GlobalVariable>(global).setInitializer(nullptr);
+            }
+
+            global.setLinkage(llvm::GlobalValue::LinkageTypes::ExternalLinkage);
+            global.setComdat(nullptr);
+
+            return;
+        }
+
+        // Linkonce code is dropped once inlined or unused, but the next inputs may still call it
+        if (global.hasLinkOnceLinkage())
+        {
+            global.setLinkage(llvm::GlobalValue::LinkageTypes::WeakAnyLinkage);
+        }
+    };
+
+    for (auto &function : module->functions())
+    {
+        extract(function);
+    }
+
+    for (auto &global : module->globals())
+    {
+        extract(global);
+    }
+
+    return module;
+}
+
+ReplResult Repl::evaluate(const std::string &input)
+{
+    ReplResult result;
+    std::ostringstream errors;
+
+    auto name = "__repl_" + std::to_string(this->inputs++);
+    auto depth = this->visitor->scopes.size();
+
+    Values::Function *function = nullptr;
+    Values::GlobalVariable *value = nullptr;
+
+    this->visitor->files.push(fs::current_path() / "repl.sn");
+
+    try
+    {
+        std::istringstream stream(input);
+
+        auto context = this->visitor->read(stream);
+        value = this->visitor->generateReplInput(context, name, function);
+    }
+    catch (std::exception &e)
+    {
+        errors << e.what() << std::endl;
+    }
+    catch (...)
+    {
+        errors << "An error occured." << std::endl;
+    }
+
+    this->visitor->files.pop();
+
+    if (!errors.str().empty())
+    {
+        while (this->visitor->scopes.size() > depth)
+        {
+            this->visitor->scopes.pop_no_destruct();
+        }
+
+        this->visitor->env.builder.ClearInsertionPoint();
+
+        // Functions left half generated by the error are only declared
+        for (auto &llvm_function : this->visitor->env.module->functions())
+        {
+            for (auto &block : llvm_function)
+            {
+                if (block.getTerminator() == nullptr)
+                {
+                    llvm_function.deleteBody();
+                    break;
+                }
+            }
+        }
+
+        result.errors = errors.str();
+        return result;
+    }
+
+    auto module = this->extract_new_definitions();
+
+    Compiler compiler(module, this->visitor->env.target_machine);
+    auto object = compiler.generate_object_buffer(llvm::PassBuilder::OptimizationLevel::O0);
+
+    if (object == nullptr)
+    {
+        result.errors = "Could not generate the object file.\n";
+        return result;
+    }
+
+    if (auto error = this->jit->addObjectFile(std::move(object)))
+    {
+        result.errors = llvm::toString(std::move(error)) + "\n";
+        return result;
+    }
+
+    if (function != nullptr)
+    {
+        auto symbol = this->jit->lookup(name);
+
+        if (!symbol)
+        {
+            result.errors = llvm::toString(symbol.takeError()) + "\n";
+            return result;
+        }
+
+        auto entry = reinterpret_cast<void (*)()>(symbol->getAddress());
+
+        auto start = std::chrono::steady_clock::now();
+        entry();
+        result.elapsed = std::chrono::steady_clock::now() - start;
+    }
+
+    if (value != nullptr)
+    {
+        auto symbol = this->jit->lookup(name + ".value");
+
+        if (!symbol)
+        {
+            result.errors = llvm::toString(symbol.takeError()) + "\n";
+            return result;
+        }
+
+        result.value = format_value(reinterpret_cast<const void *>(symbol->getAddress()), value->type);
+    }
+
+    result.success = true;
+
+    return result;
+}
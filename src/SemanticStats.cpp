@@ -0,0 +1,149 @@
+#include <Sand/SemanticStats.hpp>
+
+#include <llvm/IR/Module.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+
+using namespace Sand;
+
+// Instructions of the instantiations nested in each running one
+static std::vector<uint64_t> nested_instructions;
+
+static void report_section(llvm::raw_ostream &out, const std::string &title, const std::string &key, const std::string &cost, const SemanticCounters &counters, const size_t &limit)
+{
+    uint64_t total_count = 0;
+    uint64_t total_cost = 0;
+
+    std::vector<std::pair<std::string, SemanticCounter>> ranked(counters.begin(), counters.end());
+
+    for (const auto &[_, counter] : ranked)
+    {
+        total_count += counter.count;
+        total_cost += counter.cost;
+    }
+
+    std::stable_sort(ranked.begin(), ranked.end(), [](const auto &left, const auto &right) {
+        return left.second.cost != right.second.cost ? left.second.cost > right.second.cost : left.second.count > right.second.count;
+    });
+
+    out << title << ": " << total_count;
+
+    if (!cost.empty())
+    {
+        out << ", " << total_cost << " " << cost;
+
+        if (total_count > 0)
+        {
+            out << llvm::format(" (%.2f on average)", static_cast<double>(total_cost) / total_count);
+        }
+    }
+
+    out << '\n';
+
+    if (ranked.empty())
+    {
+        out << '\n';
+        return;
+    }
+
+    size_t width = key.size();
+
+    for (size_t i = 0; i < ranked.size() && i < limit; i++)
+    {
+        width = std::max(width, ranked[i].first.size());
+    }
+
+    out << "  " << llvm::left_justify(key, width) << llvm::right_justify("count", 10);
+
+    if (!cost.empty())
+    {
+        out << llvm::right_justify(cost, 14) << llvm::right_justify("average", 10);
+    }
+
+    out << '\n';
+
+    for (size_t i = 0; i < ranked.size() && i < limit; i++)
+    {
+        const auto &[name, counter] = ranked[i];
+
+        out << "  " << llvm::left_justify(name, width) << llvm::format("%10llu", static_cast<unsigned long long>(counter.count));
+
+        if (!cost.empty())
+        {
+            out << llvm::format("%14llu", static_cast<unsigned long long>(counter.cost)) << llvm::format("%10.2f", static_cast<double>(counter.cost) / std::max<uint64_t>(counter.count, 1));
+        }
+
+        out << '\n';
+    }
+
+    if (ranked.size() > limit)
+    {
+        out << "  ... " << ranked.size() - limit << " more\n";
+    }
+
+    out << '\n';
+}
+
+std::string SemanticStats::report(const size_t &limit)
+{
+    std::string str;
+    llvm::raw_string_ostream out(str);
+
+    report_section(out, "Generic instantiations", "template", "instructions", instantiations, limit);
+    report_section(out, "Name lookups", "name", "scopes", lookups, limit);
+    report_section(out, "Overload resolutions", "function", "candidates", overloads, limit);
+    report_section(out, "Implicit casts", "conversion", "", casts, limit);
+    report_section(out, "Sret temporaries", "function", "bytes", sret_temporaries, limit);
+    report_section(out, "Destructor calls", "class", "", destructors, limit);
+
+    return out.str();
+}
+
+SemanticStats::Instantiation::Instantiation(const std::string &name_, const llvm::Module *module_, const bool &counted_)
+    : active(SemanticStats::enabled), name(name_), module(module_), counted(counted_)
+{
+    if (this->active)
+    {
+        this->functions = this->module->size();
+        nested_instructions.push_back(0);
+    }
+}
+
+SemanticStats::Instantiation::~Instantiation()
+{
+    if (!this->active)
+    {
+        return;
+    }
+
+    // Generated functions are appended to the module
+    uint64_t instructions = 0;
+    auto function = this->module->end();
+
+    for (auto size = this->module->size(); size > this->functions; size--)
+    {
+        function--;
+        instructions += function->getInstructionCount();
+    }
+
+    auto nested = nested_instructions.back();
+    nested_instructions.pop_back();
+
+    if (!nested_instructions.empty())
+    {
+        nested_instructions.back() += instructions;
+    }
+
+    instructions -= std::min(instructions, nested);
+
+    if (this->counted)
+    {
+        SemanticStats::add(SemanticStats::instantiations, this->name, instructions);
+    }
+    else
+    {
+        SemanticStats::instantiations[this->name].cost += instructions;
+    }
+}
@@ -0,0 +1,101 @@
+#include <Sand/Session.hpp>
+
+#include <Sand/Compiler.hpp>
+
+#include "grammar/Visitor.hpp"
+
+#include <llvm/Support/TargetSelect.h>
+
+#include <mutex>
+#include <sstream>
+
+using namespace Sand;
+
+Session::Session(const std::string &target_os_,
+                 const std::string &target_arch_,
+                 const std::string &target_cpu_,
+                 const std::string &target_features_,
+                 const std::string &builtins_path_,
+                 const std::vector<std::string> &include_paths_) : target_os(target_os_),
+                                                                   target_arch(target_arch_),
+                                                                   target_cpu(target_cpu_),
+                                                                   target_features(target_features_),
+                                                                   builtins_path(builtins_path_),
+                                                                   include_paths(include_paths_),
+                                                                   parse_cache(std::make_unique<ParseCache>())
+{
+    Session::initialize_targets();
+}
+
+Session::~Session()
+{
+    delete this->target_machine;
+}
+
+void Session::initialize_targets()
+{
+    static std::once_flag initialized;
+
+    std::call_once(initialized, []() {
+        llvm::InitializeAllTargetInfos();
+        llvm::InitializeAllTargets();
+        llvm::InitializeAllTargetMCs();
+        llvm::InitializeAllAsmParsers();
+        llvm::InitializeAllAsmPrinters();
+    });
+}
+
+CompilationResult Session::compile_source(const std::string &source, const std::string &name)
+{
+    return this->compile([&](Visitor &visitor) {
+        visitor.from_source(source, name);
+    });
+}
+
+CompilationResult Session::compile_file(const std::string &path)
+{
+    return this->compile([&](Visitor &visitor) {
+        visitor.from_file(path);
+    });
+}
+
+CompilationResult Session::compile(const std::function<void(Visitor &)> &load)
+{
+    CompilationResult result;
+    std::ostringstream errors;
+
+    try
+    {
+        Visitor visitor(this->target_os, this->target_arch, this->target_cpu, this->target_features, this->builtins_path, this->include_paths, this->target_machine);
+        this->target_machine = visitor.env.target_machine;
+
+        visitor.parse_cache = this->parse_cache.get();
+        visitor.load_builtins();
+        load(visitor);
+
+        Compiler compiler(visitor.env.module, visitor.env.target_machine);
+        auto object = compiler.generate_object_buffer(this->optimization_level);
+
+        if (object != nullptr)
+        {
+            result.objects.push_back(std::move(object));
+            result.success = true;
+        }
+        else
+        {
+            errors << "Could not generate the object file." << std::endl;
+        }
+    }
+    catch (std::exception &e)
+    {
+        errors << e.what() << std::endl;
+    }
+    catch (...)
+    {
+        errors << "An error occured." << std::endl;
+    }
+
+    result.errors = errors.str();
+
+    return result;
+}
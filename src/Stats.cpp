@@ -0,0 +1,345 @@
+#include <Sand/Stats.hpp>
+
+#include <llvm/IR/Module.h>
+#include <llvm/IR/PassInstrumentation.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/FormatVariadic.h>
+#include <llvm/Support/JSON.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+    #define NOMINMAX
+    #include <windows.h>
+
+    #include <psapi.h>
+#else
+    #include <sys/resource.h>
+#endif
+
+using namespace Sand;
+
+static constexpr int64_t STATS_VERSION = 1;
+
+// The names are the ones of no other kind, blocks and aliases
+static const char *OBJECT_KINDS[] = {"names", "types", "generic_types", "values", "scopes", "generics", "namespaces"};
+
+struct OpenPhase
+{
+    size_t index;
+    std::chrono::steady_clock::time_point start;
+
+    uint64_t allocated;
+    uint64_t allocations;
+    uint64_t objects[static_cast<size_t>(ObjectKind::Count)];
+};
+
+static std::vector<PhaseStats> phases;
+static std::vector<OpenPhase> open_phases;
+static const llvm::Module *current_module = nullptr;
+
+// Nesting of the running passes, only the top-level ones are phases
+static unsigned pass_depth = 0;
+
+static uint64_t read_peak_rss()
+{
+#ifdef __linux__
+    std::ifstream status("/proc/self/status");
+    std::string line;
+
+    while (std::getline(status, line))
+    {
+        if (line.compare(0, 6, "VmHWM:") == 0)
+        {
+            return std::stoull(line.substr(6)) * 1024;
+        }
+    }
+#endif
+
+#if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
+    PROCESS_MEMORY_COUNTERS counters;
+
+    if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return counters.PeakWorkingSetSize;
+    }
+
+    return 0;
+#else
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+
+    #ifdef __APPLE__
+    return usage.ru_maxrss;
+    #else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+    #endif
+#endif
+}
+
+/**
+ * The peak RSS of every open phase is at least the one of the process since the last reset
+ */
+static void sample_peak_rss()
+{
+    auto peak = read_peak_rss();
+
+    for (const auto &open : open_phases)
+    {
+        phases[open.index].peak_rss = std::max(phases[open.index].peak_rss, peak);
+    }
+}
+
+/**
+ * Linux resets the high water mark to the current RSS, elsewhere the peak of a phase is the one of the process so far
+ */
+static void reset_peak_rss()
+{
+#ifdef __linux__
+    std::ofstream clear_refs("/proc/self/clear_refs");
+    clear_refs << "5";
+#endif
+}
+
+static std::string format_bytes(const uint64_t &bytes)
+{
+    if (bytes >= (1 << 30))
+    {
+        return llvm::formatv("{0:F2} GB", bytes / double(1 << 30));
+    }
+    else if (bytes >= (1 << 20))
+    {
+        return llvm::formatv("{0:F2} MB", bytes / double(1 << 20));
+    }
+    else if (bytes >= (1 << 10))
+    {
+        return llvm::formatv("{0:F2} KB", bytes / double(1 << 10));
+    }
+
+    return llvm::formatv("{0} B", bytes);
+}
+
+void Stats::begin(const std::string &name)
+{
+    sample_peak_rss();
+
+    auto phase = std::find_if(phases.begin(), phases.end(), [&](const PhaseStats &phase) { return phase.name == name; });
+
+    if (phase == phases.end())
+    {
+        PhaseStats stats;
+        stats.name = name;
+        stats.depth = open_phases.size();
+
+        phase = phases.insert(phases.end(), stats);
+    }
+
+    OpenPhase open;
+    open.index = phase - phases.begin();
+    open.start = std::chrono::steady_clock::now();
+    open.allocated = allocated.load(std::memory_order_relaxed);
+    open.allocations = allocations.load(std::memory_order_relaxed);
+    std::copy(std::begin(objects), std::end(objects), std::begin(open.objects));
+
+    open_phases.push_back(open);
+
+    reset_peak_rss();
+}
+
+void Stats::end()
+{
+    if (open_phases.empty())
+    {
+        return;
+    }
+
+    sample_peak_rss();
+
+    auto open = open_phases.back();
+    open_phases.pop_back();
+
+    auto &phase = phases[open.index];
+    phase.runs++;
+    phase.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - open.start).count();
+    phase.allocated += allocated.load(std::memory_order_relaxed) - open.allocated;
+    phase.allocations += allocations.load(std::memory_order_relaxed) - open.allocations;
+
+    for (size_t i = 0; i < static_cast<size_t>(ObjectKind::Count); i++)
+    {
+        phase.objects[i] += objects[i] - open.objects[i];
+    }
+
+    if (current_module != nullptr)
+    {
+        phase.has_module = true;
+        phase.functions = 0;
+        phase.instructions = 0;
+        phase.globals = current_module->getGlobalList().size();
+
+        for (const auto &function : *current_module)
+        {
+            if (!function.isDeclaration())
+            {
+                phase.functions++;
+                phase.instructions += function.getInstructionCount();
+            }
+        }
+    }
+
+    reset_peak_rss();
+}
+
+void Stats::set_module(const llvm::Module *module)
+{
+    current_module = module;
+}
+
+void Stats::register_callbacks(llvm::PassInstrumentationCallbacks &callbacks)
+{
+    callbacks.registerBeforePassCallback([](llvm::StringRef pass, llvm::Any) {
+        if (pass_depth++ == 0)
+        {
+            // Pass managers and adaptors are named after their template
+            Stats::begin("pass " + pass.take_until([](char c) { return c == '<'; }).str());
+        }
+
+        return true;
+    });
+
+    callbacks.registerAfterPassCallback([](llvm::StringRef, llvm::Any) {
+        if (--pass_depth == 0)
+        {
+            Stats::end();
+        }
+    });
+
+    callbacks.registerAfterPassInvalidatedCallback([](llvm::StringRef) {
+        if (--pass_depth == 0)
+        {
+            Stats::end();
+        }
+    });
+}
+
+const std::vector<PhaseStats> &Stats::get_phases()
+{
+    return phases;
+}
+
+std::string Stats::report()
+{
+    std::string str;
+    llvm::raw_string_ostream out(str);
+
+    size_t width = 5;
+
+    for (const auto &phase : phases)
+    {
+        width = std::max(width, phase.depth * 2 + phase.name.size());
+    }
+
+    out << llvm::left_justify("phase", width) << llvm::right_justify("runs", 7) << llvm::right_justify("time", 11) << llvm::right_justify("peak RSS", 12)
+        << llvm::right_justify("allocated", 12) << llvm::right_justify("allocs", 10) << llvm::right_justify("functions", 11) << llvm::right_justify("instructions", 14)
+        << llvm::right_justify("globals", 9) << '\n';
+
+    for (const auto &phase : phases)
+    {
+        out << llvm::left_justify(std::string(phase.depth * 2, ' ') + phase.name, width) << llvm::format("%7llu", static_cast<unsigned long long>(phase.runs))
+            << llvm::format("%9.3f s", phase.seconds) << llvm::right_justify(format_bytes(phase.peak_rss), 12) << llvm::right_justify(format_bytes(phase.allocated), 12)
+            << llvm::format("%10llu", static_cast<unsigned long long>(phase.allocations));
+
+        if (phase.has_module)
+        {
+            out << llvm::format("%11llu", static_cast<unsigned long long>(phase.functions)) << llvm::format("%14llu", static_cast<unsigned long long>(phase.instructions))
+                << llvm::format("%9llu", static_cast<unsigned long long>(phase.globals));
+        }
+
+        out << '\n';
+    }
+
+    // Front-end objects, only in the phases creating some
+    out << '\n' << llvm::left_justify("phase", width);
+
+    for (const auto &kind : OBJECT_KINDS)
+    {
+        out << llvm::right_justify(kind, 15);
+    }
+
+    out << '\n';
+
+    for (const auto &phase : phases)
+    {
+        if (std::all_of(std::begin(phase.objects), std::end(phase.objects), [](const uint64_t &count) { return count == 0; }))
+        {
+            continue;
+        }
+
+        out << llvm::left_justify(std::string(phase.depth * 2, ' ') + phase.name, width);
+
+        for (const auto &count : phase.objects)
+        {
+            out << llvm::format("%15llu", static_cast<unsigned long long>(count));
+        }
+
+        out << '\n';
+    }
+
+    return out.str();
+}
+
+bool Stats::write_json(const std::string &file, std::string &errors)
+{
+    llvm::json::Array array;
+
+    for (const auto &phase : phases)
+    {
+        llvm::json::Object objects;
+
+        for (size_t i = 0; i < static_cast<size_t>(ObjectKind::Count); i++)
+        {
+            objects[OBJECT_KINDS[i]] = static_cast<int64_t>(phase.objects[i]);
+        }
+
+        llvm::json::Object object{
+            {"name", phase.name},
+            {"depth", static_cast<int64_t>(phase.depth)},
+            {"runs", static_cast<int64_t>(phase.runs)},
+            {"seconds", phase.seconds},
+            {"peak_rss", static_cast<int64_t>(phase.peak_rss)},
+            {"allocated", static_cast<int64_t>(phase.allocated)},
+            {"allocations", static_cast<int64_t>(phase.allocations)},
+            {"objects", std::move(objects)},
+        };
+
+        if (phase.has_module)
+        {
+            object["module"] = llvm::json::Object{
+                {"functions", static_cast<int64_t>(phase.functions)},
+                {"instructions", static_cast<int64_t>(phase.instructions)},
+                {"globals", static_cast<int64_t>(phase.globals)},
+            };
+        }
+
+        array.push_back(std::move(object));
+    }
+
+    std::error_code error;
+    llvm::raw_fd_ostream out(file, error);
+
+    if (error)
+    {
+        errors = "Could not write the statistics '" + file + "', " + error.message() + ".\n";
+        return false;
+    }
+
+    out << llvm::formatv("{0:2}", llvm::json::Value(llvm::json::Object{{"version", STATS_VERSION}, {"phases", std::move(array)}})) << '\n';
+
+    return true;
+}
@@ -0,0 +1,400 @@
+#include <Sand/ThroughputAnalyzer.hpp>
+
+#include <llvm/MC/MCAsmInfo.h>
+#include <llvm/MC/MCContext.h>
+#include <llvm/MC/MCInst.h>
+#include <llvm/MC/MCInstrInfo.h>
+#include <llvm/MC/MCObjectFileInfo.h>
+#include <llvm/MC/MCParser/MCAsmParser.h>
+#include <llvm/MC/MCParser/MCTargetAsmParser.h>
+#include <llvm/MC/MCRegisterInfo.h>
+#include <llvm/MC/MCStreamer.h>
+#include <llvm/MC/MCSubtargetInfo.h>
+#include <llvm/MC/MCTargetOptions.h>
+
+#include <llvm/MCA/Context.h>
+#include <llvm/MCA/HWEventListener.h>
+#include <llvm/MCA/InstrBuilder.h>
+#include <llvm/MCA/Pipeline.h>
+#include <llvm/MCA/SourceMgr.h>
+#include <llvm/MCA/Support.h>
+
+#include <llvm/Support/Format.h>
+#include <llvm/Support/SourceMgr.h>
+#include <llvm/Support/TargetRegistry.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include <algorithm>
+#include <map>
+#include <set>
+
+using namespace Sand;
+
+namespace
+{
+struct Block
+{
+    std::string name;
+    std::vector<llvm::MCInst> instructions;
+};
+
+/**
+ * Receives the parsed assembly and keeps the instructions of the analyzed functions, split in basic blocks:
+ * a block starts at a block label or after a branch.
+ */
+class InstructionCollector : public llvm::MCStreamer
+{
+private:
+    const llvm::MCInstrInfo &instr_info;
+    std::string block_prefix;
+    char global_prefix;
+
+    const std::set<std::string> &functions;
+    std::string current_function;
+
+    bool new_block = false;
+
+    void start_block(const std::string &name)
+    {
+        this->blocks[this->current_function].push_back({name, {}});
+        this->new_block = false;
+    }
+
+public:
+    std::map<std::string, std::vector<Block>> blocks;
+
+    InstructionCollector(llvm::MCContext &context, const llvm::MCInstrInfo &instr_info_, const std::set<std::string> &functions_) : llvm::MCStreamer(context),
+                                                                                                                                       instr_info(instr_info_),
+                                                                                                                                       functions(functions_)
+    {
+        auto asm_info = context.getAsmInfo();
+
+        this->block_prefix = asm_info->getPrivateLabelPrefix().str() + "BB";
+        this->global_prefix = asm_info->getGlobalPrefix();
+    }
+
+    void ChangeSection(llvm::MCSection *section, const llvm::MCExpr *subsection) override
+    {
+        llvm::MCStreamer::ChangeSection(section, subsection);
+        this->current_function.clear();
+    }
+
+    void EmitLabel(llvm::MCSymbol *symbol, llvm::SMLoc loc) override
+    {
+        llvm::MCStreamer::EmitLabel(symbol, loc);
+
+        auto name = symbol->getName().str();
+
+        if (this->global_prefix != '\0' && !name.empty() && name[0] == this->global_prefix)
+        {
+            name = name.substr(1);
+        }
+
+        if (this->functions.count(name))
+        {
+            this->current_function = name;
+            this->start_block(name);
+        }
+        else if (!this->current_function.empty() && symbol->getName().startswith(this->block_prefix))
+        {
+            this->start_block(symbol->getName().str());
+        }
+    }
+
+    void EmitInstruction(const llvm::MCInst &instruction, const llvm::MCSubtargetInfo &subtarget_info) override
+    {
+        if (this->current_function.empty())
+        {
+            return;
+        }
+
+        auto &function_blocks = this->blocks[this->current_function];
+
+        if (this->new_block)
+        {
+            this->start_block(this->current_function + "+" + std::to_string(function_blocks.size()));
+        }
+
+        function_blocks.back().instructions.push_back(instruction);
+
+        const auto &description = this->instr_info.get(instruction.getOpcode());
+
+        if (description.isBranch() || description.isReturn())
+        {
+            this->new_block = true;
+        }
+    }
+
+    bool EmitSymbolAttribute(llvm::MCSymbol *symbol, llvm::MCSymbolAttr attribute) override
+    {
+        return true;
+    }
+
+    void EmitCommonSymbol(llvm::MCSymbol *symbol, uint64_t size, unsigned byte_alignment) override {}
+
+    void EmitZerofill(llvm::MCSection *section, llvm::MCSymbol *symbol = nullptr, uint64_t size = 0, unsigned byte_alignment = 0, llvm::SMLoc loc = llvm::SMLoc()) override {}
+
+    void EmitGPRel32Value(const llvm::MCExpr *value) override {}
+
+    void BeginCOFFSymbolDef(const llvm::MCSymbol *symbol) override {}
+
+    void EmitCOFFSymbolStorageClass(int storage_class) override {}
+
+    void EmitCOFFSymbolType(int type) override {}
+
+    void EndCOFFSymbolDef() override {}
+};
+
+/**
+ * Counts the retired instructions, the cycles each processor resource is used and why the dispatch stalled
+ */
+class PipelineListener : public llvm::mca::HWEventListener
+{
+private:
+    std::vector<uint64_t> masks;
+
+    bool resources_pressure = false;
+    bool register_pressure = false;
+    bool memory_pressure = false;
+
+public:
+    unsigned retired = 0;
+    unsigned cycles = 0;
+
+    unsigned resources_cycles = 0;
+    unsigned register_cycles = 0;
+    unsigned memory_cycles = 0;
+
+    std::vector<double> resource_cycles;
+
+    PipelineListener(const llvm::MCSchedModel &model) : masks(model.getNumProcResourceKinds()), resource_cycles(model.getNumProcResourceKinds(), 0)
+    {
+        llvm::mca::computeProcResourceMasks(model, this->masks);
+    }
+
+    void onEvent(const llvm::mca::HWInstructionEvent &event) override
+    {
+        if (event.Type == llvm::mca::HWInstructionEvent::Retired)
+        {
+            this->retired++;
+        }
+        else if (event.Type == llvm::mca::HWInstructionEvent::Issued)
+        {
+            const auto &issued = static_cast<const llvm::mca::HWInstructionIssuedEvent &>(event);
+
+            for (const auto &use : issued.UsedResources)
+            {
+                auto it = std::find(this->masks.begin(), this->masks.end(), use.first.first);
+
+                if (it != this->masks.end())
+                {
+                    this->resource_cycles[it - this->masks.begin()] += double(use.second);
+                }
+            }
+        }
+    }
+
+    void onEvent(const llvm::mca::HWPressureEvent &event) override
+    {
+        switch (event.Reason)
+        {
+        case llvm::mca::HWPressureEvent::RESOURCES:
+            this->resources_pressure = true;
+            break;
+        case llvm::mca::HWPressureEvent::REGISTER_DEPS:
+            this->register_pressure = true;
+            break;
+        case llvm::mca::HWPressureEvent::MEMORY_DEPS:
+            this->memory_pressure = true;
+            break;
+        default:
+            break;
+        }
+    }
+
+    void onCycleEnd() override
+    {
+        this->cycles++;
+
+        this->resources_cycles += this->resources_pressure;
+        this->register_cycles += this->register_pressure;
+        this->memory_cycles += this->memory_pressure;
+
+        this->resources_pressure = false;
+        this->register_pressure = false;
+        this->memory_pressure = false;
+    }
+};
+} // namespace
+
+std::string ThroughputAnalyzer::analyze(const std::string &assembly, const std::vector<std::string> &functions)
+{
+    std::string report;
+    llvm::raw_string_ostream out(report);
+
+    auto &target = this->target_machine->getTarget();
+    auto triple = this->target_machine->getTargetTriple();
+    auto cpu = this->target_machine->getTargetCPU();
+
+    auto register_info = this->target_machine->getMCRegisterInfo();
+    auto asm_info = this->target_machine->getMCAsmInfo();
+    auto instr_info = this->target_machine->getMCInstrInfo();
+    auto subtarget_info = this->target_machine->getMCSubtargetInfo();
+
+    const auto &model = subtarget_info->getSchedModel();
+
+    if (!model.hasInstrSchedModel())
+    {
+        out << "No scheduling model for the CPU '" << cpu << "', the throughput can't be analyzed.\n";
+        return out.str();
+    }
+
+    llvm::SourceMgr source_manager;
+    source_manager.AddNewSourceBuffer(llvm::MemoryBuffer::getMemBuffer(assembly, "assembly"), llvm::SMLoc());
+
+    llvm::MCObjectFileInfo object_file_info;
+    llvm::MCContext context(asm_info, register_info, &object_file_info, &source_manager);
+    object_file_info.InitMCObjectFileInfo(triple, false, context);
+
+    std::set<std::string> names(functions.begin(), functions.end());
+    InstructionCollector collector(context, *instr_info, names);
+
+    std::unique_ptr<llvm::MCAsmParser> parser(llvm::createMCAsmParser(source_manager, context, collector, *asm_info));
+    std::unique_ptr<llvm::MCTargetAsmParser> target_parser(target.createMCAsmParser(*subtarget_info, *parser, *instr_info, llvm::MCTargetOptions()));
+
+    if (target_parser == nullptr)
+    {
+        out << "No assembly parser for the target '" << triple.str() << "'.\n";
+        return out.str();
+    }
+
+    parser->setTargetParser(*target_parser);
+
+    if (parser->Run(false))
+    {
+        out << "The generated assembly could not be parsed.\n";
+        return out.str();
+    }
+
+    llvm::mca::Context mca_context(*register_info, *subtarget_info);
+    llvm::mca::InstrBuilder instr_builder(*subtarget_info, *instr_info, *register_info, nullptr);
+
+    // Default dispatch width, register file and queues of the scheduling model, with bottleneck analysis
+    llvm::mca::PipelineOptions options(0, 0, 0, 0, true, true);
+
+    for (const auto &function : functions)
+    {
+        auto it = collector.blocks.find(function);
+
+        if (it == collector.blocks.end())
+        {
+            out << "Function '" << function << "' not found in the generated code.\n";
+            continue;
+        }
+
+        out << "Throughput of '" << function << "' on " << cpu << " (" << this->iterations << " iterations of each block)\n";
+
+        for (const auto &block : it->second)
+        {
+            if (block.instructions.empty())
+            {
+                continue;
+            }
+
+            std::vector<std::unique_ptr<llvm::mca::Instruction>> instructions;
+            std::string error;
+
+            for (const auto &instruction : block.instructions)
+            {
+                auto result = instr_builder.createInstruction(instruction);
+
+                if (!result)
+                {
+                    error = llvm::toString(result.takeError());
+                    break;
+                }
+
+                instructions.push_back(std::move(*result));
+            }
+
+            out << "\n  " << block.name << ": " << block.instructions.size() << " instructions\n";
+
+            if (!error.empty())
+            {
+                out << "    " << error << "\n";
+                continue;
+            }
+
+            llvm::mca::SourceMgr source(instructions, this->iterations);
+            auto pipeline = mca_context.createDefaultPipeline(options, source);
+
+            PipelineListener listener(model);
+            pipeline->addEventListener(&listener);
+
+            auto cycles = pipeline->run();
+
+            if (!cycles)
+            {
+                out << "    " << llvm::toString(cycles.takeError()) << "\n";
+                continue;
+            }
+
+            auto total_cycles = std::max(listener.cycles, 1u);
+
+            out << "    cycles per iteration: " << llvm::format("%.2f", double(total_cycles) / this->iterations);
+            out << ", IPC: " << llvm::format("%.2f", double(listener.retired) / total_cycles) << "\n";
+
+            // The most used resources first
+            std::vector<std::pair<double, unsigned>> pressure;
+
+            for (unsigned i = 1; i < listener.resource_cycles.size(); i++)
+            {
+                if (listener.resource_cycles[i] > 0)
+                {
+                    pressure.push_back({listener.resource_cycles[i] / this->iterations, i});
+                }
+            }
+
+            std::sort(pressure.rbegin(), pressure.rend());
+
+            out << "    resource pressure per iteration:";
+
+            for (const auto &[cycles_per_iteration, index] : pressure)
+            {
+                out << " " << model.getProcResource(index)->Name << " " << llvm::format("%.2f", cycles_per_iteration);
+            }
+
+            out << "\n";
+
+            auto percent = [&](const unsigned &stall_cycles) {
+                return llvm::format("%.1f%%", 100.0 * stall_cycles / total_cycles);
+            };
+
+            out << "    dispatch stalls: resources " << percent(listener.resources_cycles) << ", register dependencies " << percent(listener.register_cycles)
+                << ", memory dependencies " << percent(listener.memory_cycles) << "\n";
+
+            auto bottleneck = std::max({listener.resources_cycles, listener.register_cycles, listener.memory_cycles});
+
+            if (bottleneck * 10 < total_cycles)
+            {
+                out << "    bottleneck: none\n";
+            }
+            else if (bottleneck == listener.resources_cycles)
+            {
+                out << "    bottleneck: " << (pressure.empty() ? "resources" : model.getProcResource(pressure[0].second)->Name) << "\n";
+            }
+            else if (bottleneck == listener.register_cycles)
+            {
+                out << "    bottleneck: register dependencies\n";
+            }
+            else
+            {
+                out << "    bottleneck: memory dependencies\n";
+            }
+        }
+
+        out << "\n";
+    }
+
+    return out.str();
+}
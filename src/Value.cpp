@@ -1,5 +1,8 @@
 #include <Sand/Value.hpp>
 
+#include <Sand/ABI.hpp>
+#include <Sand/SemanticStats.hpp>
+
 #include <Sand/Values/Constant.hpp>
 #include <Sand/Values/Variable.hpp>
 
@@ -8,6 +11,17 @@
 
 using namespace Sand;
 
+// Conversions emitting an instruction or folding a constant, for --semantic-stats
+static void count_cast(Type *type, Type *dest, llvm::Value *from, llvm::Value *to)
+{
+    if (SemanticStats::enabled && from != to)
+    {
+        auto type_name = [](Type *type) { return type->name.empty() ? type->to_string() : type->name; };
+
+        SemanticStats::add(SemanticStats::casts, type_name(type) + " -> " + type_name(dest));
+    }
+}
+
 Value *Value::call(llvm::IRBuilder<> &builder, std::unique_ptr<llvm::Module> &module, std::vector<Value *> args)
 {
     auto called_type = this->type;
@@ -45,8 +59,34 @@ Value *Value::call(llvm::IRBuilder<> &builder, std::unique_ptr<llvm::Module> &mo
                 arg = reference;
             }
 
-            auto casted = arg->cast(function_arg.type, builder, module);
-            llvm_args.push_back(casted->get_ref());
+            auto &abi = type->args_abi[i + start];
+
+            if (abi.kind == ABIKind::Direct)
+            {
+                auto casted = arg->cast(function_arg.type, builder, module);
+                llvm_args.push_back(casted->get_ref());
+            }
+            else
+            {
+                auto address = arg->cast(function_arg.type, builder, module, false)->get_address(builder);
+
+                if (abi.kind == ABIKind::Coerced)
+                {
+                    llvm_args.push_back(ABI::coerce(address->get_ref(), function_arg.type, abi.coerced_type, builder, module));
+                }
+                else if (abi.is_byval || arg->is_temporary)
+                {
+                    // Temporaries are not used after the call, they don't need a defensive copy
+                    llvm_args.push_back(address->get_ref());
+                }
+                else
+                {
+                    auto copy = Values::Variable::create("copy", function_arg.type, builder);
+                    copy->store(address, builder, module);
+
+                    llvm_args.push_back(copy->get_ref());
+                }
+            }
         }
         else
         {
@@ -61,16 +101,39 @@ Value *Value::call(llvm::IRBuilder<> &builder, std::unique_ptr<llvm::Module> &mo
         tmp->can_be_taken = true;
         tmp->is_temporary = true;
 
+        if (SemanticStats::enabled)
+        {
+            SemanticStats::add(SemanticStats::sret_temporaries, this->name, module->getDataLayout().getTypeAllocSize(type->return_type->get_ref()));
+        }
+
         llvm_args.insert(llvm_args.begin(), tmp->get_ref());
 
         auto call = builder.CreateCall(type->get_ref(), this->get_ref(), llvm_args);
-        call->addAttribute(1, llvm::Attribute::StructRet);
+        call->setCallingConv(type->calling_convention);
+        call->setAttributes(type->get_abi_attributes(builder.getContext()));
+
+        return tmp;
+    }
+    else if (type->return_abi.kind == ABIKind::Coerced)
+    {
+        auto call = builder.CreateCall(type->get_ref(), this->get_ref(), llvm_args);
+        call->setCallingConv(type->calling_convention);
+        call->setAttributes(type->get_abi_attributes(builder.getContext()));
+
+        auto tmp = Values::Variable::create("tmp", type->return_type, builder);
+        tmp->can_be_taken = true;
+        tmp->is_temporary = true;
+
+        ABI::uncoerce(call, tmp->get_ref(), type->return_type, builder, module);
 
         return tmp;
     }
     else
     {
         auto ret = builder.CreateCall(type->get_ref(), this->get_ref(), llvm_args);
+        ret->setCallingConv(type->calling_convention);
+        ret->setAttributes(type->get_abi_attributes(builder.getContext()));
+
         return new Value("call", type->return_type, static_cast<llvm::Value *>(ret));
     }
 }
@@ -824,6 +887,8 @@ Value *Value::cast(Type *dest, llvm::IRBuilder<> &builder, std::unique_ptr<llvm:
             ref = builder.CreateIntToPtr(ref, dest->ref);
         }
 
+        count_cast(type, dest, value->get_ref(), ref);
+
         return new Value(this->name, dest, ref);
     }
     else if (type->is_double())
@@ -844,6 +909,8 @@ Value *Value::cast(Type *dest, llvm::IRBuilder<> &builder, std::unique_ptr<llvm:
             }
         }
 
+        count_cast(type, dest, value->get_ref(), ref);
+
         return new Value(this->name, dest, ref);
     }
     else if (type->is_float())
@@ -864,6 +931,8 @@ Value *Value::cast(Type *dest, llvm::IRBuilder<> &builder, std::unique_ptr<llvm:
             }
         }
 
+        count_cast(type, dest, value->get_ref(), ref);
+
         return new Value(this->name, dest, ref);
     }
     else if (type->is_pointer())
@@ -882,6 +951,8 @@ Value *Value::cast(Type *dest, llvm::IRBuilder<> &builder, std::unique_ptr<llvm:
             ref = builder.CreateBitCast(ref, dest->ref);
         }
 
+        count_cast(type, dest, value->get_ref(), ref);
+
         return new Value(this->name, dest, ref);
     }
     else if (type->is_struct())
@@ -903,6 +974,8 @@ Value *Value::cast(Type *dest, llvm::IRBuilder<> &builder, std::unique_ptr<llvm:
             {
                 if (parent == target)
                 {
+                    count_cast(type, dest, nullptr, ref);
+
                     return struct_cast(target, padding, builder);
                 }
 
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "runtime/SandParser.h"
+
+#include <Sand/filesystem.hpp>
+
+#include <string>
+
+namespace Sand
+{
+/**
+ * Write the interface (.sni) of a module: its declarations without the bodies of its functions.
+ * Generic functions and classes are kept whole since they are instantiated by the importers.
+ */
+class InterfaceWriter
+{
+private:
+    static std::string text(antlr4::Token *start, antlr4::Token *stop)
+    {
+        return start->getInputStream()->getText(antlr4::misc::Interval(start->getStartIndex(), stop->getStopIndex()));
+    }
+
+    static std::string text(antlr4::ParserRuleContext *context)
+    {
+        return text(context->getStart(), context->getStop());
+    }
+
+    static std::string text_before(antlr4::ParserRuleContext *context, antlr4::Token *end)
+    {
+        auto start = context->getStart();
+        return start->getInputStream()->getText(antlr4::misc::Interval(start->getStartIndex(), end->getStartIndex() - 1));
+    }
+
+    static std::string writeFunction(SandParser::FunctionContext *context, antlr4::ParserRuleContext *from)
+    {
+        if (context->functionDeclaration()->classGenerics() || !context->body())
+        {
+            return text(from);
+        }
+
+        return text(from->getStart(), context->functionDeclaration()->getStop()) + ";";
+    }
+
+    static std::string writeClassBody(antlr4::ParserRuleContext *context, SandParser::ClassBodyContext *body)
+    {
+        std::string str = text_before(context, body->getStart()) + "{\n";
+
+        for (auto &element : body->classBodyElement())
+        {
+            if (auto method = element->classMethod())
+            {
+                str += writeFunction(method->function(), method);
+            }
+            else if (auto class_statement = element->classStatement())
+            {
+                str += writeClass(class_statement);
+            }
+            else
+            {
+                str += text(element);
+            }
+
+            str += "\n";
+        }
+
+        return str + "}";
+    }
+
+    static std::string writeClass(SandParser::ClassStatementContext *context)
+    {
+        if (context->classGenerics())
+        {
+            return text(context);
+        }
+
+        return writeClassBody(context, context->classBody());
+    }
+
+    /**
+     * Relative imports are resolved from the module, the interface may be moved to an include path
+     */
+    static std::string writeImport(SandParser::ImportStatementContext *context, const fs::path &file)
+    {
+        auto literal = context->StringLiteral()->getText();
+        auto path = literal.substr(1, literal.size() - 2);
+
+        if (path.compare(0, 2, "./") != 0 && path.compare(0, 3, "../") != 0)
+        {
+            return text(context);
+        }
+
+        auto absolute_path = fs::path(file).replace_filename(path).lexically_normal();
+
+        return "import \"" + absolute_path.generic_u8string() + "\"";
+    }
+
+    static std::string writeStatements(const std::vector<SandParser::StatementContext *> &statements, const fs::path &file)
+    {
+        std::string str;
+
+        for (auto &statement : statements)
+        {
+            if (auto function = statement->function())
+            {
+                auto name = function->functionDeclaration()->VariableName();
+
+                // Each program defines its own entry point
+                if (name && name->getText() == "main")
+                {
+                    continue;
+                }
+
+                str += writeFunction(function, function);
+            }
+            else if (auto namespace_statement = statement->namespaceStatement())
+            {
+                str += text(namespace_statement->getStart(), namespace_statement->VariableName()->getSymbol()) + " {\n";
+                str += writeStatements(namespace_statement->statement(), file);
+                str += "}";
+            }
+            else if (auto class_statement = statement->classStatement())
+            {
+                str += writeClass(class_statement);
+            }
+            else if (auto special_class_statement = statement->specialClassStatement())
+            {
+                str += writeClassBody(special_class_statement, special_class_statement->classBody());
+            }
+            else if (auto import_statement = statement->importStatement())
+            {
+                str += writeImport(import_statement, file);
+            }
+            else if (statement->variableDeclaration() || statement->unionStatement() || statement->enumStatement() || statement->alias())
+            {
+                str += text(statement);
+            }
+            else
+            {
+                continue;
+            }
+
+            str += "\n";
+        }
+
+        return str;
+    }
+
+public:
+    static std::string write(SandParser::InstructionsContext *context, const fs::path &file)
+    {
+        return writeStatements(context->statement(), file);
+    }
+};
+} // namespace Sand
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "runtime/SandParser.h"
+
+#include <Sand/filesystem.hpp>
+
+#include <map>
+
+namespace Sand
+{
+/**
+ * Parse trees of the files read by previous compilations of a Session, reused while the files are unchanged.
+ * Like the trees of a single compilation, they are never freed.
+ */
+class ParseCache
+{
+private:
+    struct Entry
+    {
+        fs::file_time_type last_write_time;
+        SandParser::InstructionsContext *context = nullptr;
+    };
+
+    std::map<fs::path, Entry> entries;
+
+public:
+    SandParser::InstructionsContext *get(const fs::path &path, const fs::file_time_type &last_write_time) const
+    {
+        auto it = this->entries.find(path);
+
+        if (it == this->entries.end() || it->second.last_write_time != last_write_time)
+        {
+            return nullptr;
+        }
+
+        return it->second.context;
+    }
+
+    void add(const fs::path &path, const fs::file_time_type &last_write_time, SandParser::InstructionsContext *context)
+    {
+        this->entries[path] = {last_write_time, context};
+    }
+};
+} // namespace Sand
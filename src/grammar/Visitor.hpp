@@ -2,16 +2,25 @@
 
 #include "runtime/SandParserBaseVisitor.h"
 
+#include "ParseCache.hpp"
 #include "ParserErrorListener.hpp"
 
 #include <llvm/ADT/SmallVector.h>
+#include <llvm/Analysis/CaptureTracking.h>
+#include <llvm/Analysis/ValueTracking.h>
 #include <llvm/IR/InlineAsm.h>
+#include <llvm/IR/InstIterator.h>
+#include <llvm/Support/TimeProfiler.h>
 #include <llvm/Transforms/Utils/Evaluator.h>
 
+#include <Sand/DebugInfo.hpp>
 #include <Sand/Debugger.hpp>
 #include <Sand/Environment.hpp>
 #include <Sand/Helpers.hpp>
+#include <Sand/SemanticStats.hpp>
+#include <Sand/Stats.hpp>
 
+#include <Sand/ABI.hpp>
 #include <Sand/Alias.hpp>
 #include <Sand/AssemblyOperand.hpp>
 #include <Sand/Attributes.hpp>
@@ -66,6 +75,7 @@
 #include <cstdint>
 #include <limits>
 #include <regex>
+#include <sstream>
 #include <tuple>
 
 namespace Sand
@@ -83,15 +93,31 @@ public:
 
     size_t generating_properties_stack = 0;
 
+    // Greater than zero while loading a module interface (.sni), its globals are only declared
+    size_t interface_depth = 0;
+
+    // Functions defined in this file are exported for separate compilation
+    fs::path exported_file;
+
+    // Imports may be loaded from module interfaces (.sni), their objects are linked separately (build -c, --objects)
+    bool use_interfaces = false;
+
+    // Set with `-g`, function bodies are described as they are generated
+    std::unique_ptr<DebugInfo> debug_info;
+
+    // Set by a Session, the files unchanged since a previous compilation are not parsed again
+    ParseCache *parse_cache = nullptr;
+
     Visitor(const std::string &target_os,
             const std::string &target_arch,
             const std::string &target_cpu,
             const std::string &target_features,
             const std::string &builtins_path_,
-            const std::vector<std::string> &include_paths_ = {}) : env("output", target_os, target_arch, target_cpu, target_features),
-                                                                   include_paths(include_paths_),
-                                                                   builtins_path(builtins_path_),
-                                                                   scopes(this->env)
+            const std::vector<std::string> &include_paths_ = {},
+            llvm::TargetMachine *target_machine_ = nullptr) : env("output", target_os, target_arch, target_cpu, target_features, target_machine_),
+                                                              include_paths(include_paths_),
+                                                              builtins_path(builtins_path_),
+                                                              scopes(this->env)
     {
         auto std_directory = Environment::get_std_directory();
 
@@ -116,7 +142,7 @@ public:
         }
     }
 
-    void from_file(std::string path)
+    SandParser::InstructionsContext *from_file(std::string path)
     {
         if (!this->files.empty())
         {
@@ -142,6 +168,15 @@ public:
                         path = fullpath.u8string();
                         break;
                     }
+
+                    // Module compiled separately, only its interface is available
+                    fullpath.replace_extension(".sni");
+
+                    if (this->use_interfaces && fs::exists(fullpath))
+                    {
+                        path = fullpath.u8string();
+                        break;
+                    }
                 }
             }
         }
@@ -160,18 +195,115 @@ public:
 
         fullpath = fs::canonical(fullpath);
 
+        // Imported modules are loaded from their interface when it is up to date
+        if (this->use_interfaces && !this->files.empty() && fullpath.extension() == ".sn")
+        {
+            auto interface_path = fullpath;
+            interface_path.replace_extension(".sni");
+
+            if (fs::exists(interface_path) && fs::last_write_time(interface_path) >= fs::last_write_time(fullpath))
+            {
+                fullpath = interface_path;
+            }
+        }
+
         if (std::find(imported.begin(), imported.end(), fullpath) != imported.end())
         {
-            return;
+            return nullptr;
         }
 
         imported.push_back(fullpath);
 
-        std::ifstream stream;
-        stream.open(fullpath);
+        auto is_interface = fullpath.extension() == ".sni";
+
+        if (is_interface)
+        {
+            this->interface_depth++;
+        }
+
+        Stats::Phase phase("import " + fullpath.u8string());
 
         this->files.push(fullpath);
+        auto context = this->parseFile(fullpath);
+        files.pop();
+
+        if (is_interface)
+        {
+            this->interface_depth--;
+        }
+
+        return context;
+    }
+
+    /**
+     * Compile source code from memory, `name` is used to resolve its relative imports
+     */
+    SandParser::InstructionsContext *from_source(const std::string &source, const std::string &name = "input.sn")
+    {
+        std::istringstream stream(source);
+
+        this->files.push(fs::absolute(name));
+        auto context = this->parse(stream);
+        files.pop();
+
+        return context;
+    }
+
+    SandParser::InstructionsContext *parse(std::istream &stream)
+    {
+        auto file = this->files.empty() ? std::string() : this->files.top().u8string();
+        SandParser::InstructionsContext *context = nullptr;
+
+        {
+            llvm::TimeTraceScope time_scope("Parse", file);
+            context = this->read(stream);
+        }
 
+        return this->elaborate(context);
+    }
+
+    SandParser::InstructionsContext *parseFile(const fs::path &path)
+    {
+        auto last_write_time = fs::last_write_time(path);
+        SandParser::InstructionsContext *context = nullptr;
+
+        if (this->parse_cache != nullptr)
+        {
+            context = this->parse_cache->get(path, last_write_time);
+        }
+
+        if (context == nullptr)
+        {
+            std::ifstream stream(path);
+
+            llvm::TimeTraceScope time_scope("Parse", path.u8string());
+            context = this->read(stream);
+
+            if (this->parse_cache != nullptr)
+            {
+                this->parse_cache->add(path, last_write_time, context);
+            }
+        }
+
+        return this->elaborate(context);
+    }
+
+    SandParser::InstructionsContext *elaborate(SandParser::InstructionsContext *context)
+    {
+        auto file = this->files.empty() ? std::string() : this->files.top().u8string();
+
+        // Imports are elaborated in the scope of the file importing them
+        llvm::TimeTraceScope time_scope("Elaborate", file);
+        this->visitInstructions(context);
+
+        return context;
+    }
+
+    /**
+     * Parse source code without elaborating it
+     */
+    SandParser::InstructionsContext *read(std::istream &stream)
+    {
         auto input = new ANTLRInputStream(stream);
         auto lexer = new SandLexer(input);
         auto tokens = new CommonTokenStream(lexer);
@@ -181,16 +313,110 @@ public:
         // auto error_listener = new ParserErrorListener(this->env.debugger);
         // parser->addErrorListener(error_listener);
 
-        SandParser::InstructionsContext *context = parser->instructions();
+        return parser->instructions();
+    }
 
-        this->visitInstructions(context);
+    /**
+     * Top-level functions are elaborated in two passes: every declaration of the file first, then the bodies.
+     * A body can then call any function of its file, whatever their order.
+     */
+    void visitInstructions(SandParser::InstructionsContext *context)
+    {
+        this->visitTopLevelStatements(context->statement());
+    }
 
-        files.pop();
+    void visitTopLevelStatements(const std::vector<SandParser::StatementContext *> &statements)
+    {
+        std::vector<std::pair<SandParser::FunctionContext *, Values::Function *>> pending_bodies;
+
+        for (const auto &statement : statements)
+        {
+            if (auto function_context = statement->function())
+            {
+                if (auto function = dynamic_cast<Values::Function *>(this->visitFunction(function_context, true, false)))
+                {
+                    pending_bodies.push_back(std::make_pair(function_context, function));
+                }
+            }
+            else
+            {
+                this->visitStatement(statement);
+            }
+        }
+
+        for (auto &[function_context, function] : pending_bodies)
+        {
+            this->generateFunctionBody(function_context, function);
+        }
     }
 
-    void visitInstructions(SandParser::InstructionsContext *context)
+    /**
+     * Elaborate an input of the REPL: declarations stay at the top level, the other statements are generated into the `void name()` function.
+     * The value of a trailing scalar expression is stored into the `name.value` global, which is returned.
+     */
+    Values::GlobalVariable *generateReplInput(SandParser::InstructionsContext *context, const std::string &name, Values::Function *&function)
     {
-        this->visitStatements(context->statement());
+        std::vector<SandParser::StatementContext *> declarations;
+        std::vector<SandParser::StatementContext *> statements;
+
+        for (const auto &statement : context->statement())
+        {
+            if (statement->expression() || statement->body() || statement->ifStatement() || statement->whileStatement() || statement->forStatement() || statement->assemblyStatement())
+            {
+                statements.push_back(statement);
+            }
+            else
+            {
+                declarations.push_back(statement);
+            }
+        }
+
+        this->visitTopLevelStatements(declarations);
+
+        function = nullptr;
+
+        if (statements.empty())
+        {
+            return nullptr;
+        }
+
+        auto scope = this->scopes.top();
+
+        auto function_type = Types::FunctionType::create(scope->builder(), scope->module(), name, scope->get_primary_type("void"), {});
+        function = new Values::Function(scope->module(), function_type, llvm::GlobalValue::LinkageTypes::ExternalLinkage);
+
+        this->scopes.create(function);
+        auto body_scope = this->scopes.create();
+
+        auto block = Block::create(body_scope->builder(), "entry");
+        function->insert(block);
+        block->insert_point(body_scope->builder());
+
+        Values::GlobalVariable *result = nullptr;
+
+        for (const auto &statement : statements)
+        {
+            auto value = dynamic_cast<Value *>(this->visitStatement(statement));
+
+            if (statement == statements.back() && statement->expression() && value != nullptr)
+            {
+                value = value->load_alloca_and_reference(body_scope->builder());
+
+                if (value->type->is_integer() || value->type->is_floating_point() || value->type->is_pointer())
+                {
+                    result = Values::GlobalVariable::create(name + ".value", scope->module(), value->type);
+                    result->store(value, body_scope->builder(), scope->module());
+                }
+            }
+        }
+
+        this->scopes.call_destructors(body_scope);
+        body_scope->builder().CreateRetVoid();
+
+        this->scopes.pop_no_destruct();
+        this->scopes.pop_no_destruct();
+
+        return result;
     }
 
     StatementStatus visitStatements(const std::vector<SandParser::StatementContext *> &statements)
@@ -221,6 +447,11 @@ public:
 
     Name *visitStatement(SandParser::StatementContext *context)
     {
+        if (this->debug_info != nullptr && this->scopes.top()->in_function())
+        {
+            this->env.builder.SetCurrentDebugLocation(DebugInfo::get_location(this->scopes.top()->get_function(), context->getStart()));
+        }
+
         if (auto function = context->function())
         {
             return this->visitFunction(function);
@@ -315,13 +546,16 @@ public:
             auto is_extern = !!context->Extern() || function_type->name == "main";
             auto linkage = is_extern ? llvm::GlobalValue::LinkageTypes::ExternalLinkage : llvm::GlobalValue::LinkageTypes::LinkOnceAnyLinkage;
 
-            auto function = new Values::Function(scope->module(), function_type, linkage);
-
-            if (attributes.is("noinline"))
+            // Unused linkonce functions may be dropped, but other objects call the exported ones.
+            // They have a single definition, so ThinLTO can import them into their callers.
+            if (!is_extern && !this->exported_file.empty() && this->files.top() == this->exported_file)
             {
-                function->get_ref()->addAttribute(llvm::AttributeList::FunctionIndex, llvm::Attribute::NoInline);
+                linkage = llvm::GlobalValue::LinkageTypes::WeakODRLinkage;
             }
 
+            auto function = new Values::Function(scope->module(), function_type, linkage);
+            this->applyFunctionAttributes(function, attributes, context);
+
             if (add_to_scope)
             {
                 scope->add_name(function->name, function);
@@ -371,6 +605,9 @@ public:
             auto function = new Values::Function(scope->module(), function_type);
             generic->children.push_back(function);
 
+            auto attributes = this->visitAttributes(context->attributes());
+            this->applyFunctionAttributes(function, attributes, context);
+
             this->generateFunctionBody(context, function);
 
             position.load(scope->builder());
@@ -384,11 +621,19 @@ public:
 
     Values::Function *generateFunctionBody(SandParser::FunctionContext *context, Values::Function *base)
     {
+        llvm::TimeTraceScope time_scope("Function", [&]() { return base->get_ref()->getName().str(); });
+
         this->scopes.create(base);
 
         if (auto body = context->body())
         {
             this->visitBody(body, base);
+            this->markTailCalls(base);
+        }
+        else
+        {
+            // Declarations are resolved at link time
+            base->get_ref()->setLinkage(llvm::GlobalValue::LinkageTypes::ExternalLinkage);
         }
 
         this->scopes.pop();
@@ -396,6 +641,108 @@ public:
         return base;
     }
 
+    void applyFunctionAttributes(Values::Function *function, const Attributes &attributes, SandParser::FunctionContext *context)
+    {
+        auto function_ref = function->get_ref();
+        auto function_type = function->get_type();
+
+        if (attributes.is("inline"))
+        {
+            function_ref->addFnAttr(llvm::Attribute::AlwaysInline);
+        }
+        else if (attributes.is("noinline"))
+        {
+            function_ref->addFnAttr(llvm::Attribute::NoInline);
+        }
+
+        if (attributes.is("hot"))
+        {
+            function_ref->addFnAttr(llvm::Attribute::InlineHint);
+            function_ref->setSectionPrefix(".hot");
+        }
+        else if (attributes.is("cold"))
+        {
+            function_ref->addFnAttr(llvm::Attribute::Cold);
+            function_ref->addFnAttr(llvm::Attribute::OptimizeForSize);
+            function_ref->setSectionPrefix(".unlikely");
+        }
+
+        // Throughput report of its machine code, like `--mca=<function>`
+        if (attributes.is("analyze"))
+        {
+            function_ref->addFnAttr("sand-analyze");
+        }
+
+        // Run and timed by `sand bench`
+        if (attributes.is("bench"))
+        {
+            function_ref->addFnAttr("sand-bench");
+        }
+
+        // Instrumented with `--xray` whatever its size, or never
+        if (attributes.get("xray") == "always")
+        {
+            function_ref->addFnAttr("function-instrument", "xray-always");
+        }
+        else if (attributes.get("xray") == "never")
+        {
+            function_ref->addFnAttr("function-instrument", "xray-never");
+        }
+
+        // A sret function writes its result through the hidden pointer, it can't be readonly/readnone
+        if (!function_type->is_sret)
+        {
+            // Classes passed in memory are read through a pointer, which readnone forbids
+            auto has_indirect_args = std::any_of(function_type->args_abi.begin(), function_type->args_abi.end(), [](const ABIInfo &abi) { return abi.kind == ABIKind::Indirect; });
+
+            // `const` is a keyword, so the GCC-like `const` attribute is spelled `readnone`
+            if (attributes.is("readnone") && !has_indirect_args)
+            {
+                function_ref->addFnAttr(llvm::Attribute::ReadNone);
+                function_ref->addFnAttr(llvm::Attribute::NoUnwind);
+            }
+            else if (attributes.is("readnone") || attributes.is("pure"))
+            {
+                function_ref->addFnAttr(llvm::Attribute::ReadOnly);
+                function_ref->addFnAttr(llvm::Attribute::NoUnwind);
+            }
+        }
+
+        // Returns go through the shared return block, so calls in return position are marked `tail` instead of `musttail`
+        function->is_tailcall = attributes.is("tailcall");
+
+        if (attributes.has("callconv"))
+        {
+            auto callconv = attributes.get("callconv");
+            auto token = this->getAttributeToken(context->attributes(), "callconv");
+
+            // Extern functions and main are called by C code
+            if (function_ref->hasExternalLinkage())
+            {
+                throw InvalidValueException(this->files.top(), token, token->getText() + " (#[callconv] can't be used on an extern function)");
+            }
+
+            if (callconv == "fast")
+            {
+                function_type->calling_convention = llvm::CallingConv::Fast;
+            }
+            else if (callconv == "cold")
+            {
+                function_type->calling_convention = llvm::CallingConv::Cold;
+            }
+            else if (callconv == "c")
+            {
+                function_type->calling_convention = llvm::CallingConv::C;
+            }
+            else
+            {
+                throw InvalidValueException(this->files.top(), token, token->getText() + " (#[callconv] accepts \"c\", \"fast\" and \"cold\")");
+            }
+
+            function_ref->setCallingConv(function_type->calling_convention);
+        }
+    }
+
     /**
      * Return value can be a pointer of FunctionType or GenericFunctionType
      */
@@ -520,6 +867,9 @@ public:
 
     Values::Function *generateGenericFunction(Types::GenericFunctionType *generic, const std::vector<Name *> &generics)
     {
+        llvm::TimeTraceScope time_scope("InstantiateFunction", generic->name);
+        SemanticStats::Instantiation instantiation("fn " + generic->name, this->env.module.get());
+
         Position position;
 
         if (this->scopes.top()->in_function())
@@ -591,6 +941,7 @@ public:
         auto scope = this->scopes.create();
 
         auto block = Block::create(scope->builder(), "entry");
+        auto previous_location = scope->builder().getCurrentDebugLocation();
 
         if (function == nullptr)
         {
@@ -614,6 +965,16 @@ public:
 
             auto function_ref = function->get_ref();
 
+            // The function is described from its declaration, the body only starts at its brace
+            auto declaration = dynamic_cast<antlr4::ParserRuleContext *>(context->parent);
+            auto function_token = declaration != nullptr ? declaration->getStart() : context->getStart();
+
+            if (this->debug_info != nullptr)
+            {
+                this->debug_info->create_function(function, this->files.top(), function_token->getLine());
+                scope->builder().SetCurrentDebugLocation(DebugInfo::get_location(function, function_token));
+            }
+
             if (!return_type->is_void())
             {
                 if (function_type->is_sret)
@@ -637,21 +998,52 @@ public:
             }
 
             auto fa = function_type->args.begin();
+            auto abi = function_type->args_abi.begin();
 
             while (it != function_ref->arg_end())
             {
                 it->setName(fa->name);
 
-                llvm::AllocaInst *addr = this->env.builder.CreateAlloca(it->getType(), nullptr, fa->name + ".addr");
-                this->env.builder.CreateStore(llvm::cast<llvm::Value>(it), addr, false);
+                if (abi->kind == ABIKind::Indirect)
+                {
+                    scope->add_name(fa->name, new Values::Variable(fa->name, fa->type, llvm::cast<llvm::Value>(it)));
+
+                    if (this->debug_info != nullptr)
+                    {
+                        this->debug_info->declare_variable(llvm::cast<llvm::Value>(it), fa->name, fa->type, this->files.top(), function, function_token, scope->builder(), fa - function_type->args.begin() + 1);
+                    }
+                }
+                else if (abi->kind == ABIKind::Coerced)
+                {
+                    llvm::AllocaInst *addr = this->env.builder.CreateAlloca(fa->type->get_ref(), nullptr, fa->name + ".addr");
+                    ABI::uncoerce(llvm::cast<llvm::Value>(it), addr, fa->type, this->env.builder, this->env.module);
 
-                scope->add_name(fa->name, new Values::Variable(fa->name, fa->type, llvm::cast<llvm::Value>(addr)));
+                    scope->add_name(fa->name, new Values::Variable(fa->name, fa->type, llvm::cast<llvm::Value>(addr)));
+
+                    if (this->debug_info != nullptr)
+                    {
+                        this->debug_info->declare_variable(addr, fa->name, fa->type, this->files.top(), function, function_token, scope->builder(), fa - function_type->args.begin() + 1);
+                    }
+                }
+                else
+                {
+                    llvm::AllocaInst *addr = this->env.builder.CreateAlloca(it->getType(), nullptr, fa->name + ".addr");
+                    this->env.builder.CreateStore(llvm::cast<llvm::Value>(it), addr, false);
+
+                    scope->add_name(fa->name, new Values::Variable(fa->name, fa->type, llvm::cast<llvm::Value>(addr)));
+
+                    if (this->debug_info != nullptr)
+                    {
+                        this->debug_info->declare_variable(addr, fa->name, fa->type, this->files.top(), function, function_token, scope->builder(), fa - function_type->args.begin() + 1);
+                    }
+                }
 
                 it++;
                 fa++;
+                abi++;
             }
 
-            if (!function_type->is_sret && function->return_value != nullptr && !dynamic_cast<Types::ClassType *>(function_type->return_type))
+            if (!function_type->is_sret && function->return_value != nullptr && !function_type->return_type->is_struct())
             {
                 auto allocated_type = llvm::cast<llvm::AllocaInst>(function->return_value->get_ref())->getAllocatedType();
                 auto type = new Type("", allocated_type);
@@ -689,11 +1081,18 @@ public:
             {
                 scope->builder().CreateRetVoid();
             }
+            else if (function_type->return_abi.kind == ABIKind::Coerced)
+            {
+                auto return_value = ABI::coerce(function->return_value->get_ref(), return_type, function_type->return_abi.coerced_type, scope->builder(), this->env.module);
+                scope->builder().CreateRet(return_value);
+            }
             else
             {
                 const auto return_value = scope->builder().CreateLoad(function->return_value->get_ref());
                 scope->builder().CreateRet(return_value);
             }
+
+            scope->builder().SetCurrentDebugLocation(previous_location);
         }
 
         this->scopes.pop_no_destruct();
@@ -738,9 +1137,15 @@ public:
                 {
                     variable->get_ref()->setName(name);
                     variable->is_temporary = false;
+                    variable->can_be_taken = false;
 
                     scope->add_name(name, variable);
 
+                    if (this->debug_info != nullptr)
+                    {
+                        this->debug_info->declare_variable(variable->get_ref(), name, type, this->files.top(), scope->get_function(), context->getStart(), scope->builder());
+                    }
+
                     return variable;
                 }
             }
@@ -759,6 +1164,11 @@ public:
 
             scope->add_name(name, var);
 
+            if (this->debug_info != nullptr)
+            {
+                this->debug_info->declare_variable(var->get_ref(), name, type, this->files.top(), scope->get_function(), context->getStart(), scope->builder());
+            }
+
             return var;
         }
         else
@@ -768,6 +1178,14 @@ public:
                 rvalue = Values::Constant::null_value(type);
             }
 
+            if (this->interface_depth > 0)
+            {
+                auto global = Values::GlobalVariable::declare(name, scope->module(), type);
+                scope->add_name(name, global);
+
+                return global;
+            }
+
             if (auto constant = dynamic_cast<Values::Constant *>(rvalue))
             {
                 auto casted_constant = constant->cast(type, scope->builder(), scope->module());
@@ -795,6 +1213,8 @@ public:
             throw ReturnOutsideOfFunctionException(this->files.top(), context->getStart());
         }
 
+        Value *moved = nullptr;
+
         if (auto expression_context = context->expression())
         {
             auto rvalue = this->valueFromExpression(expression_context);
@@ -805,16 +1225,114 @@ public:
                 throw ReturnValueDoesNotMatchReturnTypeException(this->files.top(), expression_context->getStart(), rvalue->type, function_return_type);
             }
 
+            if (function->is_tailcall)
+            {
+                if (auto call = llvm::dyn_cast<llvm::CallInst>(rvalue->get_ref()))
+                {
+                    function->tail_calls.push_back(call);
+                }
+            }
+
             if (!function_return_type->is_void())
             {
-                function->return_value->store(rvalue, scope->builder(), scope->module(), true);
+                if (!this->elideReturnCopy(function, rvalue))
+                {
+                    function->return_value->store(rvalue, scope->builder(), scope->module(), true);
+                }
+
+                // A local class instance is moved into the return value, so it must not be destroyed
+                if (function_return_type->is_struct() && !rvalue->type->is_reference && dynamic_cast<Values::Variable *>(rvalue) && !dynamic_cast<Values::GlobalVariable *>(rvalue))
+                {
+                    moved = rvalue;
+                }
             }
         }
 
-        this->scopes.call_destructors(scope);
+        this->scopes.call_destructors(scope, moved);
         function->return_block->br(scope->builder());
     }
 
+    /**
+     * `tail` promises the callee doesn't access the allocas of the caller, nor its byval and sret arguments.
+     * Arguments are often pointers to them (`.addr` and `copy` temporaries, references to locals), and they may
+     * be reached through memory once their address escapes, so the calls are only marked when none of them does.
+     */
+    void markTailCalls(Values::Function *function)
+    {
+        if (function->tail_calls.empty())
+        {
+            return;
+        }
+
+        auto function_ref = function->get_ref();
+
+        for (auto &argument : function_ref->args())
+        {
+            if ((argument.hasByValAttr() || argument.hasStructRetAttr()) && llvm::PointerMayBeCaptured(&argument, false, true))
+            {
+                return;
+            }
+        }
+
+        for (auto &instruction : llvm::instructions(function_ref))
+        {
+            if (llvm::isa<llvm::AllocaInst>(instruction) && llvm::PointerMayBeCaptured(&instruction, false, true))
+            {
+                return;
+            }
+        }
+
+        auto &data_layout = function_ref->getParent()->getDataLayout();
+
+        for (auto call : function->tail_calls)
+        {
+            auto can_tail_call = std::none_of(call->arg_begin(), call->arg_end(), [&](const llvm::Use &arg) {
+                if (!arg->getType()->isPointerTy())
+                {
+                    return false;
+                }
+
+                auto object = llvm::GetUnderlyingObject(arg.get(), data_layout);
+                auto argument = llvm::dyn_cast<llvm::Argument>(object);
+
+                return llvm::isa<llvm::AllocaInst>(object) || (argument != nullptr && (argument->hasByValAttr() || argument->hasStructRetAttr()));
+            });
+
+            if (can_tail_call)
+            {
+                call->setTailCall();
+            }
+        }
+    }
+
+    /**
+     * Construct a temporary returned by value directly in the return slot instead of copying it
+     */
+    bool elideReturnCopy(Values::Function *function, Value *rvalue)
+    {
+        auto variable = dynamic_cast<Values::Variable *>(rvalue);
+
+        if (variable == nullptr || !variable->can_be_taken || !variable->type->equals(function->return_value->type))
+        {
+            return false;
+        }
+
+        auto alloca = llvm::dyn_cast<llvm::AllocaInst>(variable->get_ref());
+
+        if (alloca == nullptr || alloca->getType() != function->return_value->get_ref()->getType())
+        {
+            return false;
+        }
+
+        alloca->replaceAllUsesWith(function->return_value->get_ref());
+        alloca->eraseFromParent();
+
+        variable->ref = function->return_value->get_ref();
+        variable->can_be_taken = false;
+
+        return true;
+    }
+
     void visitIfStatement(SandParser::IfStatementContext *context)
     {
         auto scope = this->scopes.create();
@@ -1272,6 +1790,9 @@ public:
 
     Types::ClassType *generateGenericClassType(Types::GenericClassType *generic, const std::vector<Name *> &generics)
     {
+        llvm::TimeTraceScope time_scope("InstantiateClass", generic->name);
+        SemanticStats::Instantiation instantiation("class " + generic->name, this->env.module.get());
+
         Position position;
 
         if (this->scopes.top()->in_function())
@@ -1481,7 +2002,17 @@ public:
             }
             else
             {
-                auto variable = Values::GlobalVariable::create(property->name, this->env.module, property->type, property->default_value);
+                Values::GlobalVariable *variable = nullptr;
+
+                if (this->interface_depth > 0)
+                {
+                    variable = Values::GlobalVariable::declare(property->name, this->env.module, property->type);
+                }
+                else
+                {
+                    variable = Values::GlobalVariable::create(property->name, this->env.module, property->type, property->default_value);
+                }
+
                 type->static_scope->add_name(property->name, variable);
             }
         }
@@ -1504,6 +2035,14 @@ public:
 
     void generatePendingMethods(Types::ClassType *type)
     {
+        // The methods of a nested class template are deferred after its instantiation, they are charged to it here
+        std::unique_ptr<SemanticStats::Instantiation> instantiation;
+
+        if (!type->generics.empty())
+        {
+            instantiation = std::make_unique<SemanticStats::Instantiation>("class " + type->name, this->env.module.get(), false);
+        }
+
         // Extract and clear pending_methods to prevent recursive generation
         auto pending_methods = type->pending_methods;
         type->pending_methods.clear();
@@ -1550,6 +2089,8 @@ public:
             }
         }
 
+        type->methods_declared = true;
+
         for (auto property : type->properties)
         {
             this->generatePropertyPendingMethods(property->type);
@@ -1819,6 +2360,7 @@ public:
         auto type = this->visitClassTypeName(context->classTypeName());
 
         auto var = Values::Variable::create(type->name + ".inst", type, scope->builder());
+        var->can_be_taken = true;
 
         std::vector<std::string> assigned_properties;
 
@@ -3052,6 +3594,8 @@ public:
 
     Value *valueFromName(Name *name, antlr4::ParserRuleContext *context)
     {
+        Value *value = nullptr;
+
         if (auto array = dynamic_cast<NameArray *>(name))
         {
             while (auto alias = dynamic_cast<Alias *>(array->last()))
@@ -3064,17 +3608,28 @@ public:
                 throw MultipleInstancesException(this->files.top(), context->getStart());
             }
 
-            if (auto value = dynamic_cast<Value *>(array->last()))
-            {
-                return value;
-            }
+            value = dynamic_cast<Value *>(array->last());
+        }
+        else
+        {
+            value = dynamic_cast<Value *>(name);
         }
-        else if (auto value = dynamic_cast<Value *>(name))
+
+        if (value == nullptr)
         {
-            return value;
+            throw InvalidValueException(this->files.top(), context->getStart());
         }
 
-        throw InvalidValueException(this->files.top(), context->getStart());
+        // Function pointer types don't carry the calling convention, a #[callconv] function can only be called directly
+        if (auto function = dynamic_cast<Values::Function *>(value))
+        {
+            if (function->get_type()->calling_convention != llvm::CallingConv::C)
+            {
+                throw InvalidValueException(this->files.top(), context->getStart(), context->getText() + " (the address of a #[callconv] function can't be taken)");
+            }
+        }
+
+        return value;
     }
 
     Type *typeFromName(Name *name, antlr4::ParserRuleContext *context)
@@ -4056,6 +4611,27 @@ public:
         return attributes;
     }
 
+    /**
+     * Value of the attribute `name`, or its name when it has no value, for error messages
+     */
+    antlr4::Token *getAttributeToken(SandParser::AttributesContext *context, const std::string &name)
+    {
+        for (auto &attribute_context : context->attribute())
+        {
+            if (attribute_context->VariableName()->getText() == name)
+            {
+                if (auto literal = attribute_context->StringLiteral())
+                {
+                    return literal->getSymbol();
+                }
+
+                return attribute_context->VariableName()->getSymbol();
+            }
+        }
+
+        return context->getStart();
+    }
+
     std::pair<std::string, std::string> visitAttribute(SandParser::AttributeContext *context)
     {
         auto key = context->VariableName()->getText();
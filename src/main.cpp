@@ -3,9 +3,19 @@
 #include <Lexer.h>
 #include <Parser.h>
 
+#include <Sand/Benchmark.hpp>
 #include <Sand/Compiler.hpp>
+#include <Sand/DebugInfo.hpp>
 #include <Sand/Debugger.hpp>
+#include <Sand/DependencyFile.hpp>
 #include <Sand/Linker.hpp>
+#include <Sand/Profiler.hpp>
+#include <Sand/Repl.hpp>
+#include <Sand/SemanticStats.hpp>
+#include <Sand/Server.hpp>
+#include <Sand/Session.hpp>
+#include <Sand/Stats.hpp>
+#include <Sand/Watcher.hpp>
 
 #include <Sand/Helpers.hpp>
 
@@ -15,14 +25,26 @@
 #include "grammar/runtime/SandLexer.h"
 #include "grammar/runtime/SandParser.h"
 
+#include "grammar/InterfaceWriter.hpp"
 #include "grammar/Visitor.hpp"
 
 #include <CLI/CLI.hpp>
 
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/LineEditor/LineEditor.h>
 #include <llvm/Passes/PassBuilder.h>
-#include <llvm/Support/TargetSelect.h>
+#include <llvm/Support/TimeProfiler.h>
+#include <llvm/Support/xxhash.h>
 
+#include <cstdlib>
+#include <fstream>
 #include <map>
+#include <new>
+#include <sstream>
+
+#ifdef SAND_HAS_WATCH
+    #include <sys/wait.h>
+#endif
 
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) || defined(__NT__)
     #define CURRENT_OS      "windows"
@@ -52,6 +74,32 @@
     #define CURRENT_ARCH "i386"
 #endif
 
+// Every allocation of the compiler is counted for --stats, the array and aligned forms end up here or are not counted
+void *operator new(std::size_t size)
+{
+    if (Sand::Stats::enabled)
+    {
+        Sand::Stats::allocate(size);
+    }
+
+    if (auto pointer = std::malloc(size != 0 ? size : 1))
+    {
+        return pointer;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
 std::map<std::string_view, std::vector<std::string_view>> available_architectures = {
     {"windows", {"i386", "x86_64"}},
     {"linux", {"i386", "x86_64"}},
@@ -120,13 +168,59 @@ struct Options
     bool disable_internal = false;
 
     std::vector<std::string> libraries;
+    std::vector<std::string> objects;
     std::string args;
 
     std::string optimization_level = "0";
+    unsigned jobs = 1;
+
+    bool debug_info = false;
+    bool frame_pointers = false;
+
+    std::string lto = "none";
+    std::string lto_cache;
+
+    bool profile_generate = false;
+    std::string profile_use;
+    std::string call_trace;
+
+    bool xray = false;
+    unsigned xray_threshold = 200;
+
+    std::vector<std::string> mca_functions;
+
+    // Set by `profile`, links the sampling runtime
+    bool sampling = false;
+
+    // Set by `bench`, main is replaced by a driver timing the `#[bench]` functions matching `bench_filter`
+    bool bench = false;
+    std::string bench_filter;
+
+    std::string remarks_file;
+    std::string remarks_format = "yaml";
+    std::string remarks_passes;
+
+    bool compile_only = false;
+
+    bool write_dependency_file = false;
+    std::string dependency_file;
+    bool skip_unchanged = false;
 
     bool print_llvm = false;
     bool timer = false;
+
+    bool time_trace = false;
+    unsigned time_trace_granularity = 500;
+
+    bool stats = false;
+    std::string stats_json;
+    bool semantic_stats = false;
     bool verbose = false;
+
+    bool server = false;
+    std::string socket_path;
+
+    bool watch = false;
 };
 
 void print_bytecode(std::unique_ptr<llvm::Module> &module, Sand::Debugger &debug)
@@ -139,7 +233,7 @@ void print_bytecode(std::unique_ptr<llvm::Module> &module, Sand::Debugger &debug
     debug.out << out_stream.str() << std::endl;
 }
 
-bool compile(const Options &options, Sand::Debugger &debug)
+bool check_target(const Options &options, Sand::Debugger &debug)
 {
     if (!is_os_available(options.os))
     {
@@ -153,20 +247,171 @@ bool compile(const Options &options, Sand::Debugger &debug)
         return false;
     }
 
-    llvm::InitializeAllTargetInfos();
-    llvm::InitializeAllTargets();
-    llvm::InitializeAllTargetMCs();
-    llvm::InitializeAllAsmParsers();
-    llvm::InitializeAllAsmPrinters();
+    if (options.remarks_format != "yaml" && options.remarks_format != "bitstream")
+    {
+        debug.err << "Unavailable optimization remarks format: '" + options.remarks_format + "'. Available formats: yaml, bitstream." << std::endl;
+        return false;
+    }
 
-    Sand::Visitor visitor(options.os, options.arch, options.cpu, options.features, options.builtins_path, options.include_paths);
+    if (options.profile_generate && !options.profile_use.empty())
+    {
+        debug.err << "--profile-generate and --profile-use can't be used together." << std::endl;
+        return false;
+    }
+
+    if (options.profile_generate && (options.os != "linux" || options.arch != "x86_64"))
+    {
+        debug.err << "--profile-generate is only available on linux x86_64." << std::endl;
+        return false;
+    }
+
+    if (options.xray && (options.os != "linux" || options.arch != "x86_64"))
+    {
+        debug.err << "--xray is only available on linux x86_64." << std::endl;
+        return false;
+    }
+
+    if (options.lto != "none" && options.lto != "thin")
+    {
+        debug.err << "Unavailable LTO mode: '" + options.lto + "'. Available modes: none, thin." << std::endl;
+        return false;
+    }
+
+    // Only lld's ELF driver takes a symbol ordering file
+    if (!options.call_trace.empty() && options.mode != "elf")
+    {
+        debug.err << "--call-trace is only available with the elf mode." << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+fs::path get_output_file(const Options &options)
+{
+    if (options.compile_only && options.output_file == OUTPUT_FILENAME)
+    {
+        return fs::path(options.entry_file).filename().replace_extension(".o");
+    }
+
+    return options.output_file;
+}
 
+fs::path get_dependency_file(const Options &options)
+{
+    if (!options.dependency_file.empty())
+    {
+        return options.dependency_file;
+    }
+
+    return get_output_file(options).u8string() + ".d";
+}
+
+/**
+ * Hash of every option changing the output, a new hash invalidates the dependency file
+ */
+std::string get_options_hash(const Options &options)
+{
+    std::string str = options.entry_file + '\n' + get_output_file(options).u8string() + '\n' + options.builtins_path + '\n' + options.os + '\n' + options.arch + '\n' + options.mode + '\n' +
+                      options.cpu + '\n' + options.features + '\n' + options.args + '\n' + options.optimization_level + '\n' + options.lto + '\n' + options.profile_use + '\n' + options.call_trace + '\n' +
+                      (options.disable_internal ? "1" : "0") + (options.compile_only ? "1" : "0") + (options.profile_generate ? "1" : "0") + (options.debug_info ? "1" : "0") +
+                      (options.frame_pointers ? "1" : "0") + (options.sampling ? "1" : "0") +
+                      (options.bench ? "1" + options.bench_filter : "0") + (options.xray ? "1" + std::to_string(options.xray_threshold) : "0");
+
+    for (const auto &list : {options.include_paths, options.libraries, options.objects})
+    {
+        for (const auto &item : list)
+        {
+            str += '\n' + item;
+        }
+
+        str += '\n';
+    }
+
+    return llvm::utohexstr(llvm::xxHash64(str));
+}
+
+bool is_up_to_date(const Options &options, Sand::Debugger &debug)
+{
+    if (!options.skip_unchanged || !Sand::DependencyFile::is_up_to_date(get_dependency_file(options), get_output_file(options), get_options_hash(options)))
+    {
+        return false;
+    }
+
+    if (options.verbose)
+    {
+        debug.out << get_output_file(options).u8string() << " is up to date" << std::endl;
+    }
+
+    return true;
+}
+
+void create_debug_info(const Options &options, Sand::Visitor &visitor)
+{
+    visitor.debug_info = std::make_unique<Sand::DebugInfo>(visitor.env.module, options.optimization_level[0] != '0' && options.optimization_level[0] != 'd');
+}
+
+bool compile(const Options &options, Sand::Debugger &debug, Sand::Visitor &visitor, const bool &load_builtins = true)
+{
     debug.start_timer("bytecode");
 
+    SandParser::InstructionsContext *instructions = nullptr;
+
     try
     {
-        visitor.load_builtins();
-        visitor.from_file(options.entry_file);
+        // Warm visitors of the compile server already describe their builtins
+        if (options.debug_info && visitor.debug_info == nullptr)
+        {
+            create_debug_info(options, visitor);
+        }
+
+        if (load_builtins)
+        {
+            Sand::Stats::Phase phase("builtins");
+            visitor.load_builtins();
+        }
+
+        // Runtime writing the profile of an instrumented program
+        if (options.profile_generate)
+        {
+            visitor.from_file((Sand::Environment::get_std_directory() / "profile.sn").u8string());
+        }
+
+        // Runtime patching the XRay sleds and writing the trace
+        if (options.xray)
+        {
+            visitor.from_file((Sand::Environment::get_std_directory() / "xray.sn").u8string());
+        }
+
+        // Runtime sampling the stacks of `sand profile`
+        if (options.sampling)
+        {
+            visitor.from_file((Sand::Environment::get_std_directory() / "sampler.sn").u8string());
+        }
+
+        // Runtime timing the benchmarks of `sand bench`
+        if (options.bench)
+        {
+            visitor.from_file((Sand::Environment::get_std_directory() / "bench.sn").u8string());
+        }
+
+        if (options.compile_only)
+        {
+            visitor.exported_file = fs::canonical(options.entry_file);
+        }
+
+        // Without the objects of the modules compiled separately, their interfaces would not link
+        visitor.use_interfaces = options.compile_only || !options.objects.empty();
+
+        {
+            Sand::Stats::Phase phase("IR generation");
+            instructions = visitor.from_file(options.entry_file);
+        }
+
+        if (visitor.debug_info != nullptr)
+        {
+            visitor.debug_info->finalize();
+        }
     }
     catch (Sand::CompilationException &e)
     {
@@ -202,29 +447,137 @@ bool compile(const Options &options, Sand::Debugger &debug)
     {
     case '1':
         llvm_optimization_level = llvm::PassBuilder::OptimizationLevel::O1;
+        break;
     case '2':
         llvm_optimization_level = llvm::PassBuilder::OptimizationLevel::O2;
+        break;
     case '3':
         llvm_optimization_level = llvm::PassBuilder::OptimizationLevel::O3;
+        break;
     case 's':
         llvm_optimization_level = llvm::PassBuilder::OptimizationLevel::Os;
+        break;
     case 'z':
         llvm_optimization_level = llvm::PassBuilder::OptimizationLevel::Oz;
+        break;
     }
 
     debug.start_timer("objects");
 
     Sand::Compiler compiler(visitor.env.module, visitor.env.target_machine);
-    auto objects = compiler.generate_objects(options.os, options.arch, llvm_optimization_level, options.verbose);
+    compiler.profile_generate = options.profile_generate;
+    compiler.profile_use = options.profile_use;
+    compiler.call_trace = options.call_trace;
+    compiler.order_symbols = options.mode == "elf";
+    compiler.xray = options.xray;
+    compiler.xray_threshold = options.xray_threshold;
+    compiler.frame_pointers = options.frame_pointers;
+    compiler.fast_debug = options.optimization_level[0] == 'g';
+    compiler.bench = options.bench;
+    compiler.bench_filter = options.bench_filter;
+    compiler.mca_functions = options.mca_functions;
+    compiler.remarks_file = options.remarks_file;
+    compiler.remarks_format = options.remarks_format;
+
+    llvm::SmallVector<llvm::StringRef, 8> remarks_passes;
+    llvm::SplitString(options.remarks_passes, remarks_passes, ",");
+
+    for (const auto &pass : remarks_passes)
+    {
+        compiler.remarks_passes.push_back(pass.str());
+    }
+    std::vector<std::string> objects;
+
+    if (options.lto == "thin")
+    {
+        objects = compiler.generate_bitcode(llvm_optimization_level, options.verbose);
+    }
+    else
+    {
+        // A module compiled on its own is a single object file
+        objects = compiler.generate_objects(options.os, options.arch, llvm_optimization_level, options.verbose, options.compile_only || options.time_trace ? 1 : options.jobs);
+    }
+
+    if (objects.empty())
+    {
+        return false;
+    }
+
+    if (!compiler.mca_report.empty())
+    {
+        debug.out << compiler.mca_report;
+    }
+
+    if (!options.compile_only)
+    {
+        objects.insert(objects.end(), options.objects.begin(), options.objects.end());
+
+        if (options.lto == "thin")
+        {
+            objects = compiler.thin_link(objects, llvm_optimization_level, options.time_trace ? 1 : options.jobs, options.lto_cache);
+
+            if (objects.empty())
+            {
+                return false;
+            }
+        }
+    }
 
     auto elapsed_objects = debug.end_timer("objects");
 
+    auto output_file = get_output_file(options);
+
+    if (options.write_dependency_file || options.skip_unchanged)
+    {
+        auto dependencies = visitor.imported;
+
+        for (const auto &object : options.objects)
+        {
+            dependencies.push_back(fs::absolute(object));
+        }
+
+        for (const auto &profile : {options.profile_use, options.call_trace})
+        {
+            if (!profile.empty())
+            {
+                dependencies.push_back(fs::absolute(profile));
+            }
+        }
+
+        Sand::DependencyFile::write(get_dependency_file(options), output_file, dependencies, get_options_hash(options));
+    }
+
+    if (options.compile_only)
+    {
+        fs::copy_file(objects[0], output_file, fs::copy_options::overwrite_existing);
+        fs::remove(objects[0]);
+
+        // Next to the source, where the modules importing it look for it
+        auto interface_file = visitor.exported_file;
+        interface_file.replace_extension(".sni");
+
+        std::ofstream interface(interface_file);
+        interface << Sand::InterfaceWriter::write(instructions, visitor.exported_file);
+
+        if (options.timer)
+        {
+            debug.out << "Finished generating IR in " << elapsed_bytecode.count() << " secs" << std::endl;
+            debug.out << "Finished generating object files in " << elapsed_objects.count() << " secs" << std::endl;
+        }
+
+        return true;
+    }
+
     // for (const auto &object : objects)
     //     debug.out << object << std::endl;
 
     debug.start_timer("linking");
 
-    Sand::Linker::link(objects, options.os, options.arch, options.libraries, options.args, options.output_file, options.mode, options.disable_internal, options.verbose);
+    {
+        llvm::TimeTraceScope time_scope("Link", output_file.u8string());
+        Sand::Stats::Phase phase("link");
+        Sand::Linker::link(objects, options.os, options.arch, options.libraries, options.args, output_file.u8string(), options.mode, options.disable_internal, options.verbose, compiler.symbol_ordering_file);
+    }
 
     auto elapsed_linking = debug.end_timer("linking");
 
@@ -243,115 +596,801 @@ bool compile(const Options &options, Sand::Debugger &debug)
     return true;
 }
 
-int main(int argc, char **argv)
+bool compile(const Options &options, Sand::Debugger &debug)
 {
-    Sand::Debugger debug;
+    if (!check_target(options, debug))
+    {
+        return false;
+    }
 
-    CLI::App app{"App description"};
+    if (is_up_to_date(options, debug))
+    {
+        return true;
+    }
 
-    Options options;
-    std::string run_options;
+    Sand::Session::initialize_targets();
 
-    CLI::App *build = app.add_subcommand("build", "Build sources");
-    build->add_option("ENTRY", options.entry_file, "Entry file")->required()->check(CLI::ExistingFile);
+    // The profiler isn't thread safe, object files are then generated on a single thread
+    if (options.time_trace)
+    {
+        llvm::timeTraceProfilerInitialize(options.time_trace_granularity, "sand");
+    }
 
-    build->add_option("-O", options.optimization_level, "Optimization level", true);
-    build->add_option("-I", options.include_paths, "Include paths", true);
-    build->add_option("-B,--builtins", options.builtins_path, "Builtins path", true);
+    Sand::Stats::enabled = options.stats || !options.stats_json.empty();
+    Sand::SemanticStats::enabled = options.semantic_stats;
 
-    build->add_option("--arch", options.arch, "Target architecture", true);
-    build->add_option("--os", options.os, "Target operating system", true);
-    build->add_option("-m,--mode", options.mode, "Executable/Object files format", true);
-    build->add_option("--cpu", options.cpu, "Target CPU", true);
-    build->add_option("--features", options.features, "CPU features", true);
+    Sand::Visitor visitor(options.os, options.arch, options.cpu, options.features, options.builtins_path, options.include_paths);
+    Sand::Stats::set_module(visitor.env.module.get());
 
-    build->add_flag("--disable-internal", options.disable_internal, "Disable internal linked libraries");
+    auto success = compile(options, debug, visitor);
 
-    build->add_option("-l", options.libraries, "Libraries to link with");
-    build->add_option("--args", options.args, "Custom linker arguments");
+    Sand::Stats::set_module(nullptr);
 
-    build->add_option("-o,--output", options.output_file, "The output file", true);
+    if (options.stats)
+    {
+        debug.out << Sand::Stats::report();
+    }
 
-    build->add_flag("--print-llvm", options.print_llvm, "Print generated LLVM bytecode");
-    build->add_flag("--timer", options.timer, "Output the elapsed build time");
-    build->add_flag("--verbose", options.verbose, "Verbose mode");
+    if (!options.stats_json.empty())
+    {
+        std::string errors;
 
-    build->callback([&]() {
-        if (!compile(options, debug))
+        if (!Sand::Stats::write_json(options.stats_json, errors))
         {
-            exit(1);
+            debug.err << errors;
         }
-    });
-
-    CLI::App *run = app.add_subcommand("run", "Run sources");
-    run->add_option("ENTRY", options.entry_file, "Entry file")->required()->check(CLI::ExistingFile);
-
-    run->add_option("-O", options.optimization_level, "Optimization level", true);
-    run->add_option("-I", options.include_paths, "Include paths", true);
-    run->add_option("-B,--builtins", options.builtins_path, "Builtins path", true);
-
-    run->add_option("--arch", options.arch, "Target architecture", true);
-    run->add_option("--os", options.os, "Target operating system", true);
-    run->add_option("-m,--mode", options.mode, "Executable/Object files format", true);
-    run->add_option("--cpu", options.cpu, "Target CPU", true);
-    run->add_option("--features", options.features, "CPU features", true);
-
-    run->add_flag("--disable-internal", options.disable_internal, "Disable internal linked libraries");
+    }
 
-    run->add_option("-l", options.libraries, "Libraries to link with");
-    run->add_option("--args", options.args, "Custom linker arguments");
+    if (options.semantic_stats)
+    {
+        debug.out << Sand::SemanticStats::report();
+    }
 
-    run->add_flag("--verbose", options.verbose, "Verbose mode");
+    if (options.time_trace)
+    {
+        auto trace_file = get_output_file(options).u8string() + ".time-trace.json";
 
-    run->callback([&]() {
-        options.output_file = Sand::Helpers::temporary_filename();
+        std::error_code error;
+        llvm::raw_fd_ostream out(trace_file, error);
 
-        if (!compile(options, debug))
+        if (error)
         {
-            exit(1);
+            debug.err << "Could not write '" << trace_file << "', " << error.message() << "." << std::endl;
         }
         else
         {
-            std::system((options.output_file + run_options).c_str());
+            llvm::timeTraceProfilerWrite(out);
         }
-    });
 
-    std::vector<char *> args;
-    bool is_run_option = false;
+        llvm::timeTraceProfilerCleanup();
+    }
 
-    for (auto i = 0; i < argc; i++)
-    {
-        if (is_run_option)
-        {
-            std::stringstream ss;
-            ss << '"';
+    return success;
+}
 
-            for (auto &c : std::string(argv[i]))
-            {
-                if (c == '"' || c == '\\')
-                {
-                    ss << '\\';
-                    ss << c;
-                }
-                else
-                {
-                    ss << c;
-                }
-            }
+void add_compile_options(CLI::App *command, Options &options)
+{
+    command->add_option("ENTRY", options.entry_file, "Entry file")->required()->check(CLI::ExistingFile);
 
-            ss << '"';
+    command->add_option("-O", options.optimization_level, "Optimization level (0, 1, 2, 3, s, z, or g for fast debug builds)", true);
+    command->add_option("-j,--jobs", options.jobs, "Number of threads generating object files", true);
+    command->add_flag("-g", options.debug_info, "Generate debug info (DWARF, or CodeView on Windows)");
+    command->add_flag("--frame-pointers", options.frame_pointers, "Keep the frame pointer in every function");
+    command->add_option("-I", options.include_paths, "Include paths", true);
+    command->add_option("-B,--builtins", options.builtins_path, "Builtins path", true);
 
-            run_options += ' ' + ss.str();
-        }
-        else if (std::strcmp(argv[i], "--") == 0)
-        {
-            is_run_option = true;
-        }
-        else
-        {
-            args.push_back(argv[i]);
-        }
-    }
+    command->add_option("--arch", options.arch, "Target architecture", true);
+    command->add_option("--os", options.os, "Target operating system", true);
+    command->add_option("-m,--mode", options.mode, "Executable/Object files format", true);
+    command->add_option("--cpu", options.cpu, "Target CPU", true);
+    command->add_option("--features", options.features, "CPU features", true);
+
+    command->add_flag("--disable-internal", options.disable_internal, "Disable internal linked libraries");
+
+    command->add_option("--objects", options.objects, "Object files to link with, compiled with `build -c`")->check(CLI::ExistingFile);
+    command->add_option("--lto", options.lto, "Link time optimization mode (none, thin)", true);
+    command->add_option("--lto-cache", options.lto_cache, "ThinLTO cache directory");
+
+    command->add_flag("--profile-generate", options.profile_generate, "Instrument the program to write its profile to default.profraw");
+    command->add_option("--profile-use", options.profile_use, "Optimize with a profile merged by llvm-profdata")->check(CLI::ExistingFile);
+    command->add_flag("--xray", options.xray, "Add XRay sleds, the program writes a trace to the file in SAND_XRAY when it is set");
+    command->add_option("--xray-threshold", options.xray_threshold, "Instrument functions of at least this number of machine instructions", true);
+
+    command->add_option("--mca", options.mca_functions, "Report the throughput of a function's machine code on the target CPU, like #[analyze]");
+
+    command->add_option("--call-trace", options.call_trace, "Order functions and split hot and cold code from a sampled call trace")->check(CLI::ExistingFile);
+
+    command->add_flag("--time-trace", options.time_trace, "Write a Chrome trace of the compiler phases to <output>.time-trace.json");
+    command->add_option("--time-trace-granularity", options.time_trace_granularity, "Minimum duration of a traced event, in microseconds", true);
+
+    command->add_flag("--stats", options.stats, "Output the time, peak memory, allocations and module size of each compiler phase");
+    command->add_option("--stats-json", options.stats_json, "Write the statistics of the compiler phases as JSON");
+    command->add_flag("--semantic-stats", options.semantic_stats, "Output the generic instantiations, name lookups, overload resolutions, casts, sret temporaries and destructor calls, by cost");
+
+    command->add_option("-l", options.libraries, "Libraries to link with");
+    command->add_option("--args", options.args, "Custom linker arguments");
+}
+
+CLI::App *add_build_command(CLI::App &app, Options &options)
+{
+    CLI::App *build = app.add_subcommand("build", "Build sources");
+    add_compile_options(build, options);
+
+    build->add_option("-o,--output", options.output_file, "The output file", true);
+    build->add_flag("-c", options.compile_only, "Compile to an object file and a module interface (.sni), without linking");
+
+    build->add_flag("--MD", options.write_dependency_file, "Write a dependency file listing the imported sources");
+    build->add_option("--MF", options.dependency_file, "Dependency file path, defaults to the output file followed by .d");
+    build->add_flag("--skip-unchanged", options.skip_unchanged, "Skip the build when the output is newer than every file of its dependency file");
+
+    build->add_option("--opt-remarks", options.remarks_file, "Write the optimization remarks to a file");
+    build->add_option("--opt-remarks-format", options.remarks_format, "Format of the optimization remarks (yaml, bitstream)", true);
+    build->add_option("--opt-remarks-filter", options.remarks_passes, "Comma separated passes whose remarks are written (inline, loop-vectorize, licm, gvn...)");
+
+    build->add_flag("--print-llvm", options.print_llvm, "Print generated LLVM bytecode");
+    build->add_flag("--timer", options.timer, "Output the elapsed build time");
+    build->add_flag("--verbose", options.verbose, "Verbose mode");
+
+    return build;
+}
+
+#ifdef SAND_HAS_SERVER
+/**
+ * Builtins are elaborated once per target and include paths, every job is forked from them
+ */
+Sand::Visitor *get_warm_visitor(std::map<std::string, std::unique_ptr<Sand::Visitor>> &visitors, const Options &options)
+{
+    auto key = options.os + '\n' + options.arch + '\n' + options.cpu + '\n' + options.features + '\n' + options.builtins_path;
+
+    // The builtins of -g builds have debug info, optimized or not
+    if (options.debug_info)
+    {
+        key += "\n-g" + options.optimization_level;
+    }
+
+    for (const auto &include_path : options.include_paths)
+    {
+        key += '\n' + include_path;
+    }
+
+    auto it = visitors.find(key);
+
+    if (it != visitors.end())
+    {
+        return it->second.get();
+    }
+
+    auto visitor = std::make_unique<Sand::Visitor>(options.os, options.arch, options.cpu, options.features, options.builtins_path, options.include_paths);
+
+    if (options.debug_info)
+    {
+        create_debug_info(options, *visitor);
+    }
+
+    visitor->load_builtins();
+
+    return visitors.emplace(key, std::move(visitor)).first->second.get();
+}
+
+int serve(const std::string &socket_path, Sand::Debugger &debug)
+{
+    Sand::Server server(socket_path);
+
+    if (!server.listen())
+    {
+        debug.err << "Could not listen on '" << socket_path << "'." << std::endl;
+        return 1;
+    }
+
+    Sand::Session::initialize_targets();
+
+    debug.out << "Listening on " << socket_path << std::endl;
+
+    std::map<std::string, std::unique_ptr<Sand::Visitor>> visitors;
+
+    while (true)
+    {
+        std::string directory;
+        std::vector<std::string> job_args;
+
+        auto client_fd = server.accept(directory, job_args);
+
+        if (client_fd == -1)
+        {
+            return 1;
+        }
+
+        Options options;
+        Sand::Visitor *visitor = nullptr;
+
+        std::ostringstream errors;
+        Sand::Debugger job_debug(errors.rdbuf(), errors.rdbuf());
+
+        CLI::App app{"Sand compile server job"};
+        add_build_command(app, options);
+
+        std::vector<const char *> argv = {"sand", "build"};
+
+        for (const auto &arg : job_args)
+        {
+            argv.push_back(arg.c_str());
+        }
+
+        try
+        {
+            fs::current_path(directory);
+
+            app.parse(argv.size(), argv.data());
+
+            // Paths are made absolute so the warm builtins don't depend on the client directory
+            for (auto &include_path : options.include_paths)
+            {
+                include_path = fs::absolute(include_path).u8string();
+            }
+
+            if (!options.builtins_path.empty())
+            {
+                options.builtins_path = fs::absolute(options.builtins_path).u8string();
+            }
+
+            // The statistics and traces are process-wide, the server would mix the ones of every job
+            if (options.stats || !options.stats_json.empty() || options.semantic_stats || options.time_trace)
+            {
+                job_debug.err << "--stats, --stats-json, --semantic-stats and --time-trace are not supported with --server." << std::endl;
+            }
+            else if (check_target(options, job_debug))
+            {
+                visitor = get_warm_visitor(visitors, options);
+            }
+        }
+        catch (const CLI::ParseError &e)
+        {
+            app.exit(e, errors, errors);
+        }
+        catch (std::exception &e)
+        {
+            errors << e.what() << std::endl;
+        }
+
+        if (visitor == nullptr)
+        {
+            Sand::Server::send(client_fd, errors.str());
+
+            Sand::Server::finish(client_fd, 1);
+            continue;
+        }
+
+        if (is_up_to_date(options, job_debug))
+        {
+            Sand::Server::send(client_fd, errors.str());
+
+            Sand::Server::finish(client_fd, 0);
+            continue;
+        }
+
+        if (::fork() == 0)
+        {
+            auto status = Sand::Server::run(client_fd, [&]() {
+                auto success = compile(options, debug, *visitor, false);
+
+                std::cout.flush();
+                std::cerr.flush();
+
+                return success ? 0 : 1;
+            });
+
+            Sand::Server::finish(client_fd, status);
+            _exit(0);
+        }
+
+        ::close(client_fd);
+    }
+}
+
+/**
+ * Arguments of the build command as sent to the server, without the client options
+ */
+std::vector<std::string> get_server_job_args(const std::vector<char *> &args)
+{
+    std::vector<std::string> job_args;
+
+    auto it = std::find_if(args.begin(), args.end(), [](char *arg) { return std::strcmp(arg, "build") == 0; });
+
+    if (it == args.end())
+    {
+        return job_args;
+    }
+
+    for (it++; it != args.end(); it++)
+    {
+        std::string arg = *it;
+
+        if (arg == "--server" || Sand::Helpers::starts_with(arg, "--socket="))
+        {
+            continue;
+        }
+        else if (arg == "--socket")
+        {
+            if (it + 1 != args.end())
+            {
+                it++;
+            }
+
+            continue;
+        }
+
+        job_args.push_back(arg);
+    }
+
+    return job_args;
+}
+#endif
+
+/**
+ * Read inputs until their braces and parentheses are balanced, evaluate them in the JIT
+ */
+int repl(const Options &options, Sand::Debugger &debug)
+{
+    std::unique_ptr<Sand::Repl> repl;
+
+    try
+    {
+        repl = std::make_unique<Sand::Repl>(options.os, options.arch, options.cpu, options.features, options.builtins_path, options.include_paths);
+    }
+    catch (std::exception &e)
+    {
+        debug.err << e.what() << std::endl;
+        return 1;
+    }
+
+    llvm::LineEditor editor("sand");
+
+    std::string input;
+    int depth = 0;
+
+    editor.setPrompt("sand> ");
+
+    while (auto line = editor.readLine())
+    {
+        for (const auto &c : *line)
+        {
+            if (c == '{' || c == '(' || c == '[')
+                depth++;
+            else if (c == '}' || c == ')' || c == ']')
+                depth--;
+        }
+
+        input += *line + "\n";
+
+        if (depth > 0)
+        {
+            editor.setPrompt("  ... ");
+            continue;
+        }
+
+        auto result = repl->evaluate(input);
+
+        if (!result.success)
+        {
+            debug.err << result.errors;
+        }
+        else if (!result.value.empty())
+        {
+            debug.out << result.value << std::endl;
+        }
+
+        if (result.success && options.timer)
+        {
+            debug.out << "Ran in " << result.elapsed.count() << " secs" << std::endl;
+        }
+
+        input.clear();
+        depth = 0;
+
+        editor.setPrompt("sand> ");
+    }
+
+    return 0;
+}
+
+#ifdef SAND_HAS_WATCH
+/**
+ * Rebuild whenever an imported file changes.
+ * Targets and builtins stay warm in this process, every build is forked from them.
+ */
+int watch(Options options, Sand::Debugger &debug)
+{
+    if (!check_target(options, debug))
+    {
+        return 1;
+    }
+
+    Sand::Watcher watcher;
+
+    if (!watcher.is_valid())
+    {
+        debug.err << "Could not watch files: " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+
+    // The dependency file tells which files the forked build imported
+    if (options.dependency_file.empty())
+    {
+        options.dependency_file = Sand::Helpers::temporary_filename();
+    }
+
+    options.write_dependency_file = true;
+    options.skip_unchanged = false;
+
+    Sand::Session::initialize_targets();
+
+    std::unique_ptr<Sand::Visitor> visitor;
+    std::vector<fs::path> watched = {fs::canonical(options.entry_file)};
+
+    while (true)
+    {
+        if (!visitor)
+        {
+            visitor = std::make_unique<Sand::Visitor>(options.os, options.arch, options.cpu, options.features, options.builtins_path, options.include_paths);
+
+            try
+            {
+                visitor->load_builtins();
+            }
+            catch (std::exception &e)
+            {
+                debug.err << e.what() << std::endl;
+            }
+
+            watcher.watch(visitor->imported);
+        }
+
+        debug.start_timer("build");
+
+        auto pid = ::fork();
+
+        if (pid == 0)
+        {
+            _exit(compile(options, debug, *visitor, false) ? 0 : 1);
+        }
+
+        int status = 1;
+        ::waitpid(pid, &status, 0);
+
+        auto elapsed = debug.end_timer("build");
+
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 0)
+        {
+            watched = Sand::DependencyFile::read_dependencies(options.dependency_file);
+            debug.out << "Built " << get_output_file(options).u8string() << " in " << elapsed.count() << " secs, watching for changes" << std::endl;
+        }
+        else
+        {
+            // The files of the last successful build are still watched
+            debug.out << "Build failed, watching for changes" << std::endl;
+        }
+
+        watcher.watch(watched);
+
+        auto changed = watcher.wait();
+
+        for (const auto &path : changed)
+        {
+            // Only a change in the builtins makes the warm state stale
+            if (std::find(visitor->imported.begin(), visitor->imported.end(), path) != visitor->imported.end())
+            {
+                visitor.reset();
+                break;
+            }
+        }
+    }
+}
+#endif
+
+#ifdef SAND_HAS_BENCH
+int bench(Options options, Sand::Debugger &debug, const std::string &run_options, const std::string &baseline_file, const std::string &save_baseline, const double &threshold)
+{
+    if (options.os != "linux" || options.arch != "x86_64")
+    {
+        debug.err << "bench is only available on linux x86_64." << std::endl;
+        return 1;
+    }
+
+    options.output_file = Sand::Helpers::temporary_filename();
+    options.bench = true;
+
+    if (!compile(options, debug))
+    {
+        return 1;
+    }
+
+    auto samples_file = Sand::Helpers::temporary_filename();
+
+    ::setenv("SAND_BENCH", samples_file.c_str(), 1);
+    auto status = std::system((options.output_file + run_options).c_str());
+    ::unsetenv("SAND_BENCH");
+
+    fs::remove(options.output_file);
+
+    if (status != 0)
+    {
+        debug.err << "The benchmarks exited with status " << status << "." << std::endl;
+        fs::remove(samples_file);
+        return 1;
+    }
+
+    auto result = Sand::Benchmarks::read(samples_file);
+    fs::remove(samples_file);
+
+    if (!result.success)
+    {
+        debug.err << result.errors;
+        return 1;
+    }
+
+    if (result.benchmarks.empty())
+    {
+        debug.out << "No #[bench] function" << (options.bench_filter.empty() ? "" : " matching '" + options.bench_filter + "'") << std::endl;
+        return 0;
+    }
+
+    std::vector<Sand::Benchmark> baseline;
+
+    if (!baseline_file.empty())
+    {
+        auto baseline_result = Sand::Benchmarks::read_baseline(baseline_file);
+
+        if (!baseline_result.success)
+        {
+            debug.err << baseline_result.errors;
+            return 1;
+        }
+
+        baseline = baseline_result.benchmarks;
+    }
+
+    unsigned regressions = 0;
+    debug.out << Sand::Benchmarks::report(result.benchmarks, baseline, threshold / 100, regressions);
+
+    if (!save_baseline.empty())
+    {
+        std::string errors;
+
+        if (!Sand::Benchmarks::write_baseline(save_baseline, result.benchmarks, errors))
+        {
+            debug.err << errors;
+            return 1;
+        }
+    }
+
+    if (regressions != 0)
+    {
+        debug.err << regressions << " benchmark(s) regressed by more than " << threshold << "% against " << baseline_file << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+#endif
+
+#ifdef SAND_HAS_PROFILER
+int profile(Options options, Sand::Debugger &debug, const std::string &run_options, const std::string &output, const unsigned &interval)
+{
+    if (options.os != "linux" || options.arch != "x86_64")
+    {
+        debug.err << "profile is only available on linux x86_64." << std::endl;
+        return 1;
+    }
+
+    // Stacks are walked through the frame pointers and symbolized from the debug info
+    options.output_file = Sand::Helpers::temporary_filename();
+    options.debug_info = true;
+    options.frame_pointers = true;
+    options.sampling = true;
+
+    if (!compile(options, debug))
+    {
+        return 1;
+    }
+
+    auto samples_file = Sand::Helpers::temporary_filename();
+
+    ::setenv("SAND_PROFILE", samples_file.c_str(), 1);
+    ::setenv("SAND_PROFILE_INTERVAL", std::to_string(interval).c_str(), 1);
+
+    debug.start_timer("profile");
+    auto status = std::system((options.output_file + run_options).c_str());
+    auto elapsed = debug.end_timer("profile");
+
+    ::unsetenv("SAND_PROFILE");
+    ::unsetenv("SAND_PROFILE_INTERVAL");
+
+    auto result = Sand::Profiler::collapse(samples_file, options.output_file, output);
+
+    fs::remove(samples_file);
+    fs::remove(options.output_file);
+
+    if (!result.success)
+    {
+        debug.err << result.errors;
+        return 1;
+    }
+
+    debug.out << "Collected " << result.samples << " samples (" << result.stacks << " stacks) in " << elapsed.count() << " secs, written to " << output << std::endl;
+
+    if (result.dropped != 0)
+    {
+        debug.out << result.dropped << " samples were dropped, the program has too many distinct stacks" << std::endl;
+    }
+
+    return status == 0 ? 0 : 1;
+}
+#endif
+
+int main(int argc, char **argv)
+{
+    Sand::Debugger debug;
+
+    CLI::App app{"App description"};
+
+    Options options;
+    std::string run_options;
+    std::vector<std::string> server_job_args;
+
+    CLI::App *build = add_build_command(app, options);
+
+#ifdef SAND_HAS_SERVER
+    options.socket_path = Sand::Server::default_socket_path();
+
+    build->add_flag("--server", options.server, "Send the build to a running compile server");
+    build->add_option("--socket", options.socket_path, "Socket of the compile server", true);
+#endif
+
+#ifdef SAND_HAS_WATCH
+    build->add_flag("--watch", options.watch, "Rebuild when an imported file changes");
+#endif
+
+    build->callback([&]() {
+#ifdef SAND_HAS_SERVER
+        if (options.server)
+        {
+            exit(Sand::Server::request(options.socket_path, server_job_args, std::cout));
+        }
+#endif
+
+#ifdef SAND_HAS_WATCH
+        if (options.watch)
+        {
+            exit(watch(options, debug));
+        }
+#endif
+
+        if (!compile(options, debug))
+        {
+            exit(1);
+        }
+    });
+
+    CLI::App *run = app.add_subcommand("run", "Run sources");
+    add_compile_options(run, options);
+
+    run->add_flag("--verbose", options.verbose, "Verbose mode");
+
+    run->callback([&]() {
+        options.output_file = Sand::Helpers::temporary_filename();
+
+        if (!compile(options, debug))
+        {
+            exit(1);
+        }
+        else
+        {
+            std::system((options.output_file + run_options).c_str());
+        }
+    });
+
+#ifdef SAND_HAS_BENCH
+    std::string bench_baseline;
+    std::string bench_save_baseline;
+    double bench_threshold = 5;
+
+    CLI::App *bench_command = app.add_subcommand("bench", "Build sources at -O3 and time their #[bench] functions");
+    add_compile_options(bench_command, options);
+
+    bench_command->add_option("--filter", options.bench_filter, "Only run the benchmarks whose name contains this string");
+    bench_command->add_option("--baseline", bench_baseline, "Compare the medians against a baseline saved by --save-baseline")->check(CLI::ExistingFile);
+    bench_command->add_option("--save-baseline", bench_save_baseline, "Save the results as a JSON baseline");
+    bench_command->add_option("--threshold", bench_threshold, "Slowdown of the median, in percent, reported as a regression", true);
+
+    bench_command->callback([&]() {
+        // Unless -O is given
+        if (bench_command->count("-O") == 0)
+        {
+            options.optimization_level = "3";
+        }
+
+        exit(bench(options, debug, run_options, bench_baseline, bench_save_baseline, bench_threshold));
+    });
+#endif
+
+#ifdef SAND_HAS_PROFILER
+    std::string profile_output = "profile.folded";
+    unsigned profile_interval = 1000;
+
+    CLI::App *profile_command = app.add_subcommand("profile", "Run sources and sample their stacks into collapsed stacks for flame graphs");
+    add_compile_options(profile_command, options);
+
+    profile_command->add_option("-o,--output", profile_output, "The collapsed stacks file", true);
+    profile_command->add_option("--interval", profile_interval, "Microseconds of CPU time between samples", true);
+
+    profile_command->callback([&]() {
+        exit(profile(options, debug, run_options, profile_output, profile_interval));
+    });
+#endif
+
+    CLI::App *repl_command = app.add_subcommand("repl", "Evaluate statements interactively");
+
+    repl_command->add_option("-I", options.include_paths, "Include paths", true);
+    repl_command->add_option("-B,--builtins", options.builtins_path, "Builtins path", true);
+    repl_command->add_option("--cpu", options.cpu, "Target CPU", true);
+    repl_command->add_option("--features", options.features, "CPU features", true);
+    repl_command->add_flag("--timer", options.timer, "Output the time spent running each input");
+
+    repl_command->callback([&]() {
+        exit(repl(options, debug));
+    });
+
+#ifdef SAND_HAS_SERVER
+    std::string server_socket_path = Sand::Server::default_socket_path();
+
+    CLI::App *server = app.add_subcommand("server", "Start a compile server keeping targets and builtins warm");
+    server->add_option("--socket", server_socket_path, "Socket to listen on", true);
+
+    server->callback([&]() {
+        exit(serve(server_socket_path, debug));
+    });
+#endif
+
+    std::vector<char *> args;
+    bool is_run_option = false;
+
+    for (auto i = 0; i < argc; i++)
+    {
+        if (is_run_option)
+        {
+            std::stringstream ss;
+            ss << '"';
+
+            for (auto &c : std::string(argv[i]))
+            {
+                if (c == '"' || c == '\\')
+                {
+                    ss << '\\';
+                    ss << c;
+                }
+                else
+                {
+                    ss << c;
+                }
+            }
+
+            ss << '"';
+
+            run_options += ' ' + ss.str();
+        }
+        else if (std::strcmp(argv[i], "--") == 0)
+        {
+            is_run_option = true;
+        }
+        else
+        {
+            args.push_back(argv[i]);
+        }
+    }
+
+#ifdef SAND_HAS_SERVER
+    server_job_args = get_server_job_args(args);
+#endif
 
     CLI11_PARSE(app, args.size(), &args[0]);
 